@@ -0,0 +1,125 @@
+#include "bit_matrix_graph.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace kb {
+namespace {
+class BitRowEdgeIterator final : public Graph::EdgeIterator {
+public:
+  BitRowEdgeIterator(Graph::VertexTy vertex, std::span<const BitWord> row)
+      : vertex_(vertex), range_(row), it_(range_.begin()) {}
+
+  Graph::EdgeTy Get() override { return {vertex_, *it_}; }
+
+  void Next() override { ++it_; }
+
+  bool IsAtEnd() override { return it_ == range_.end(); }
+
+private:
+  Graph::VertexTy vertex_;
+  bitset::ElementRange range_;
+  bitset::ElementRange::Iterator it_;
+};
+} // namespace
+
+BitMatrixGraph::BitMatrixGraph(OrderTy order)
+    : words_(order * bitset::GetWordCount(order), 0), degrees_(order, 0),
+      view_(words_, degrees_) {}
+
+bool BitMatrixGraph::AddEdge(VertexTy a, VertexTy b) {
+  assert(a < GetOrder());
+  assert(b < GetOrder());
+  if (HasEdge(a, b))
+    return false;
+
+  bitset::Set(GetMutableRow(a), b);
+  bitset::Set(GetMutableRow(b), a);
+  degrees_[a]++;
+  if (a != b)
+    degrees_[b]++;
+  return true;
+}
+
+bool BitMatrixGraph::RemoveEdge(VertexTy a, VertexTy b) {
+  assert(a < GetOrder());
+  assert(b < GetOrder());
+  if (!HasEdge(a, b))
+    return false;
+
+  bitset::Reset(GetMutableRow(a), b);
+  bitset::Reset(GetMutableRow(b), a);
+  degrees_[a]--;
+  if (a != b)
+    degrees_[b]--;
+  return true;
+}
+
+Graph::OrderTy BitMatrixGraph::CountTriangles() const {
+  // Every triangle {u, v, w} is seen once from each of its three edges, as a
+  // common neighbor of the edge's endpoints.  Self loops make an endpoint a
+  // common neighbor of the edge too, so they are subtracted.
+  OrderTy count = 0;
+  for (VertexTy u = 0, e = view_.GetOrder(); u != e; u++) {
+    for (VertexTy v : view_.GetNeighbors(u)) {
+      if (v <= u)
+        continue;
+      count += bitset::CountIntersection(view_.GetRow(u), view_.GetRow(v));
+      count -= HasEdge(u, u) + HasEdge(v, v);
+    }
+  }
+  return count / 3;
+}
+
+std::unique_ptr<BitMatrixGraph>
+BitMatrixGraph::Permute(std::span<const VertexTy> permutation) const {
+  OrderTy order = view_.GetOrder();
+  assert(permutation.size() == order);
+  auto result = std::make_unique<BitMatrixGraph>(order);
+  for (VertexTy v = 0; v != order; v++) {
+    std::span<BitWord> row = result->GetMutableRow(permutation[v]);
+    for (VertexTy n : view_.GetNeighbors(v))
+      bitset::Set(row, permutation[n]);
+    result->degrees_[permutation[v]] = degrees_[v];
+  }
+  return result;
+}
+
+std::unique_ptr<Graph::EdgeIterator>
+BitMatrixGraph::GetEdgesContainingVertex(VertexTy v) {
+  assert(v < GetOrder());
+  return std::make_unique<BitRowEdgeIterator>(v, view_.GetRow(v));
+}
+
+std::span<const Graph::VertexTy>
+BitMatrixGraph::GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch) {
+  assert(v < GetOrder());
+  auto neighbors = view_.GetNeighbors(v);
+  scratch->assign(neighbors.begin(), neighbors.end());
+  return *scratch;
+}
+
+std::unique_ptr<Graph> BitMatrixGraph::Clone() {
+  auto clone = std::make_unique<BitMatrixGraph>(GetOrder());
+  std::copy(words_.begin(), words_.end(), clone->words_.begin());
+  std::copy(degrees_.begin(), degrees_.end(), clone->degrees_.begin());
+  return clone;
+}
+
+std::unique_ptr<BitMatrixGraph>
+CreateBitMatrixGraph(Graph::OrderTy order, std::span<Graph::EdgeTy> edges) {
+  auto g = std::make_unique<BitMatrixGraph>(order);
+  for (auto [a, b] : edges)
+    g->AddEdge(a, b);
+  return g;
+}
+
+std::unique_ptr<BitMatrixGraph> CreateBitMatrixGraph(Graph *g) {
+  auto result = std::make_unique<BitMatrixGraph>(g->GetOrder());
+  ForEachEdgeChunk(g, [&](std::span<const Graph::EdgeTy> chunk) {
+    for (auto [a, b] : chunk)
+      result->AddEdge(a, b);
+  });
+  return result;
+}
+} // namespace kb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "bitset.hpp"
+#include "graph.hpp"
+#include "graph_view.hpp"
+
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace kb {
+// Stores the adjacency of a small or dense graph as a bit matrix, one packed
+// row per vertex, and keeps the degree of every vertex.  Uses order² / 8 bytes,
+// less than CSR storage once more than about one in 32 vertex pairs is an edge.
+class BitMatrixGraph final : public Graph {
+public:
+  explicit BitMatrixGraph(OrderTy order);
+
+  BitMatrixGraph(const BitMatrixGraph &) = delete;
+  BitMatrixGraph &operator=(const BitMatrixGraph &) = delete;
+
+  // Add or remove the undirected edge (a, b).  Return false if the graph
+  // already had, or did not have, the edge.
+  bool AddEdge(VertexTy a, VertexTy b);
+  bool RemoveEdge(VertexTy a, VertexTy b);
+
+  bool HasEdge(VertexTy a, VertexTy b) const {
+    return bitset::Test(view_.GetRow(a), b);
+  }
+
+  const BitMatrixView &GetView() const { return view_; }
+
+  // The whole matrix, row by row.  Two graphs of the same order have equal
+  // words exactly if they have the same edges.
+  std::span<const BitWord> GetWords() const { return words_; }
+
+  // Returns the number of triangles, not counting self loops.
+  OrderTy CountTriangles() const;
+
+  // Returns a copy in which vertex `v` is relabeled `permutation[v]`.
+  std::unique_ptr<BitMatrixGraph>
+  Permute(std::span<const VertexTy> permutation) const;
+
+  std::unique_ptr<EdgeIterator> GetEdgesContainingVertex(VertexTy v) override;
+
+  std::span<const VertexTy>
+  GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch) override;
+
+  OrderTy GetDegree(VertexTy v) override { return degrees_[v]; }
+
+  OrderTy GetOrder() override { return degrees_.size(); }
+
+  const BitMatrixView *GetBitMatrixView() override { return &view_; }
+
+  std::unique_ptr<Graph> Clone() override;
+
+private:
+  std::span<BitWord> GetMutableRow(VertexTy v) {
+    return std::span<BitWord>(words_).subspan(v * view_.GetWordsPerRow(),
+                                              view_.GetWordsPerRow());
+  }
+
+  std::vector<BitWord> words_;
+  std::vector<OrderTy> degrees_;
+  BitMatrixView view_;
+};
+
+std::unique_ptr<BitMatrixGraph>
+CreateBitMatrixGraph(Graph::OrderTy order, std::span<Graph::EdgeTy> edges);
+
+// Copies the edges of `g` into a bit matrix.
+std::unique_ptr<BitMatrixGraph> CreateBitMatrixGraph(Graph *g);
+} // namespace kb
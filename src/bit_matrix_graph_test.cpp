@@ -0,0 +1,106 @@
+#include "bit_matrix_graph.hpp"
+
+#include "graph_analysis.hpp"
+#include "graph_zoo.hpp"
+#include "test.hpp"
+
+#include <vector>
+
+using namespace kb;
+
+static void TestBitsetOperations() {
+  std::vector<BitWord> a(2, 0), b(2, 0);
+  for (Graph::VertexTy v : {0, 5, 63, 64, 100})
+    bitset::Set(a, v);
+  for (Graph::VertexTy v : {5, 64, 65})
+    bitset::Set(b, v);
+
+  CHECK_EQ(bitset::Count(a), 5);
+  CHECK_EQ(bitset::CountIntersection(a, b), 2);
+  CHECK_EQ(bitset::CountDifference(a, b), 3);
+
+  std::vector<Graph::VertexTy> elements;
+  for (Graph::VertexTy v : bitset::ElementRange(a))
+    elements.push_back(v);
+  std::vector<Graph::VertexTy> expected_elements = {0, 5, 63, 64, 100};
+  CHECK(elements == expected_elements);
+
+  bitset::UnionWith(a, b);
+  CHECK_EQ(bitset::Count(a), 6);
+  bitset::Subtract(a, b);
+  CHECK_EQ(bitset::Count(a), 3);
+  bitset::IntersectWith(a, b);
+  CHECK_EQ(bitset::Count(a), 0);
+  CHECK(bitset::ElementRange(a).begin() == bitset::ElementRange(a).end());
+}
+
+static void TestAddAndRemoveEdges() {
+  BitMatrixGraph graph(70);
+  CHECK(graph.AddEdge(0, 69));
+  CHECK(graph.AddEdge(3, 3));
+  CHECK(graph.AddEdge(3, 65));
+  CHECK(!graph.AddEdge(69, 0));
+  CHECK(graph.HasEdge(69, 0));
+  CHECK_EQ(graph.GetDegree(3), 2);
+  CHECK(graph.RemoveEdge(65, 3));
+  CHECK(!graph.RemoveEdge(3, 65));
+  CHECK_EQ(graph.GetDegree(3), 1);
+  CHECK_EQ(graph.GetDegree(65), 0);
+  CHECK(!CheckConsistency(&graph).has_value());
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 69}, {3, 3}};
+  CHECK_EDGES_EQ(expected_edges, &graph);
+
+  std::unique_ptr<Graph> clone = graph.Clone();
+  graph.RemoveEdge(0, 69);
+  CHECK_EDGES_EQ(expected_edges, clone);
+}
+
+static void TestCountTriangles() {
+  CHECK_EQ(CreateBitMatrixGraph(CreateCompleteGraph(5, false).get())
+               ->CountTriangles(),
+           10);
+  CHECK_EQ(CreateBitMatrixGraph(CreateCompleteGraph(5, true).get())
+               ->CountTriangles(),
+           10);
+  CHECK_EQ(CreateBitMatrixGraph(CreateRingGraph(6).get())->CountTriangles(),
+           0);
+}
+
+static void TestPermute() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}, {2, 2}};
+  auto graph = CreateBitMatrixGraph(3, edges);
+  std::vector<Graph::VertexTy> permutation = {2, 0, 1};
+  auto permuted = graph->Permute(permutation);
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 2}, {0, 1}, {1, 1}};
+  CHECK_EDGES_EQ(expected_edges, permuted);
+  CHECK_EQ(permuted->GetDegree(0), 2);
+
+  auto expected = CreateBitMatrixGraph(3, expected_edges);
+  CHECK(std::ranges::equal(permuted->GetWords(), expected->GetWords()));
+}
+
+static void TestKernelsAgreeWithCsr() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}, {2, 3}, {3, 0},
+                                      {0, 4}, {4, 5}, {5, 6}, {6, 4}};
+  std::unique_ptr<Graph> csr_graph = CreateConcreteGraph(7, edges);
+  auto bit_matrix_graph = CreateBitMatrixGraph(csr_graph.get());
+  CHECK(bit_matrix_graph->GetBitMatrixView() != nullptr);
+
+  CHECK(IsRegular(bit_matrix_graph.get()) == IsRegular(csr_graph.get()));
+  CHECK(ComputeDegreeHistogram(bit_matrix_graph.get()) ==
+        ComputeDegreeHistogram(csr_graph.get()));
+  CHECK_EQ(ComputeExactCheegerConstant(bit_matrix_graph.get()),
+           ComputeExactCheegerConstant(csr_graph.get()));
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestBitsetOperations)                                                      \
+  F(TestAddAndRemoveEdges)                                                     \
+  F(TestCountTriangles)                                                        \
+  F(TestPermute)                                                               \
+  F(TestKernelsAgreeWithCsr)                                                   \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+
+namespace kb {
+// Sets of vertices packed kBitsPerWord to a word, vertex `v` being bit
+// `v % kBitsPerWord` of word `v / kBitsPerWord`.  Bits past the last vertex
+// must be zero.
+using BitWord = std::uint64_t;
+constexpr unsigned kBitsPerWord = 64;
+
+namespace bitset {
+inline size_t GetWordCount(Graph::OrderTy order) {
+  return (order + kBitsPerWord - 1) / kBitsPerWord;
+}
+
+inline bool Test(std::span<const BitWord> set, Graph::VertexTy v) {
+  return (set[v / kBitsPerWord] >> (v % kBitsPerWord)) & 1;
+}
+
+inline void Set(std::span<BitWord> set, Graph::VertexTy v) {
+  set[v / kBitsPerWord] |= BitWord(1) << (v % kBitsPerWord);
+}
+
+inline void Reset(std::span<BitWord> set, Graph::VertexTy v) {
+  set[v / kBitsPerWord] &= ~(BitWord(1) << (v % kBitsPerWord));
+}
+
+// The operations below take spans of the same size and are plain loops over
+// words, which the compiler vectorizes.
+
+inline void UnionWith(std::span<BitWord> set, std::span<const BitWord> other) {
+  assert(set.size() == other.size());
+  for (size_t i = 0, e = set.size(); i != e; i++)
+    set[i] |= other[i];
+}
+
+inline void IntersectWith(std::span<BitWord> set,
+                          std::span<const BitWord> other) {
+  assert(set.size() == other.size());
+  for (size_t i = 0, e = set.size(); i != e; i++)
+    set[i] &= other[i];
+}
+
+inline void Subtract(std::span<BitWord> set, std::span<const BitWord> other) {
+  assert(set.size() == other.size());
+  for (size_t i = 0, e = set.size(); i != e; i++)
+    set[i] &= ~other[i];
+}
+
+inline Graph::OrderTy Count(std::span<const BitWord> set) {
+  Graph::OrderTy count = 0;
+  for (BitWord word : set)
+    count += std::popcount(word);
+  return count;
+}
+
+// |a ∩ b|
+inline Graph::OrderTy CountIntersection(std::span<const BitWord> a,
+                                        std::span<const BitWord> b) {
+  assert(a.size() == b.size());
+  Graph::OrderTy count = 0;
+  for (size_t i = 0, e = a.size(); i != e; i++)
+    count += std::popcount(a[i] & b[i]);
+  return count;
+}
+
+// |a \ b|
+inline Graph::OrderTy CountDifference(std::span<const BitWord> a,
+                                      std::span<const BitWord> b) {
+  assert(a.size() == b.size());
+  Graph::OrderTy count = 0;
+  for (size_t i = 0, e = a.size(); i != e; i++)
+    count += std::popcount(a[i] & ~b[i]);
+  return count;
+}
+
+// The elements of a set, in ascending order.
+class ElementRange {
+public:
+  class Iterator {
+  public:
+    using value_type = Graph::VertexTy;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+
+    Iterator() = default;
+
+    Iterator(std::span<const BitWord> set, size_t word_index)
+        : set_(set), word_index_(word_index) {
+      if (word_index_ < set_.size())
+        word_ = set_[word_index_];
+      SkipEmptyWords();
+    }
+
+    Graph::VertexTy operator*() const {
+      return word_index_ * kBitsPerWord + std::countr_zero(word_);
+    }
+
+    Iterator &operator++() {
+      word_ &= word_ - 1;
+      SkipEmptyWords();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return word_index_ == other.word_index_ && word_ == other.word_;
+    }
+
+  private:
+    void SkipEmptyWords() {
+      while (word_ == 0 && word_index_ < set_.size()) {
+        if (++word_index_ < set_.size())
+          word_ = set_[word_index_];
+      }
+    }
+
+    std::span<const BitWord> set_;
+    size_t word_index_ = 0;
+    BitWord word_ = 0;
+  };
+
+  explicit ElementRange(std::span<const BitWord> set) : set_(set) {}
+
+  Iterator begin() const { return Iterator(set_, 0); }
+  Iterator end() const { return Iterator(set_, set_.size()); }
+
+private:
+  std::span<const BitWord> set_;
+};
+
+static_assert(std::forward_iterator<ElementRange::Iterator>);
+} // namespace bitset
+} // namespace kb
@@ -0,0 +1,286 @@
+#include "canonical.hpp"
+
+#include "bit_matrix_graph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace kb {
+namespace {
+// An ordered partition of the vertices: cell `i` is the range
+// [cell_ends[i - 1], cell_ends[i]) of `vertices`.
+struct Partition {
+  std::vector<Graph::VertexTy> vertices;
+  std::vector<Graph::OrderTy> cell_ends;
+
+  Graph::OrderTy GetCellBegin(size_t cell) const {
+    return cell == 0 ? 0 : cell_ends[cell - 1];
+  }
+
+  bool IsDiscrete() const { return cell_ends.size() == vertices.size(); }
+};
+
+class CanonicalLabeler {
+public:
+  CanonicalLabeler(Graph::OrderTy order, std::span<const BitWord> rows)
+      : order_(order), words_per_row_(bitset::GetWordCount(order)),
+        rows_(rows), splitter_(words_per_row_), parents_(order) {
+    assert(rows_.size() == order_ * words_per_row_);
+  }
+
+  std::vector<BitWord> Run(std::vector<Graph::VertexTy> *labeling,
+                           std::vector<Graph::VertexTy> *orbits) {
+    Partition unit;
+    unit.vertices.resize(order_);
+    std::iota(unit.vertices.begin(), unit.vertices.end(), 0);
+    if (order_ != 0)
+      unit.cell_ends.push_back(order_);
+    Search(std::move(unit));
+
+    if (labeling) {
+      labeling->resize(order_);
+      for (Graph::OrderTy i = 0; i != order_; i++)
+        (*labeling)[best_.vertices[i]] = i;
+    }
+    if (orbits) {
+      // The automorphisms found generate the whole group: every leaf
+      // equivalent to the first one was either visited, yielding the
+      // automorphism to it, or pruned as the image of a visited one.
+      std::iota(parents_.begin(), parents_.end(), 0);
+      for (const std::vector<Graph::VertexTy> &automorphism : automorphisms_)
+        JoinOrbits(automorphism);
+      orbits->resize(order_);
+      for (Graph::VertexTy v = 0; v != order_; v++)
+        (*orbits)[v] = FindOrbit(v);
+    }
+    return std::move(best_.form);
+  }
+
+private:
+  // A discrete partition, read as a labeling that puts vertices[i] at i.
+  struct Leaf {
+    std::vector<Graph::VertexTy> path;
+    std::vector<Graph::VertexTy> vertices;
+    std::vector<BitWord> form;
+  };
+
+  static constexpr Graph::OrderTy kNoJump =
+      std::numeric_limits<Graph::OrderTy>::max();
+
+  // Splits the first cell whose vertices differ in their number of neighbors
+  // in some cell, taking the splitting cells in order, into cells of equal
+  // counts in ascending order of count.  Returns false if the partition is
+  // equitable.  Only cell indices are used to choose the split, so refining
+  // commutes with relabeling the graph.
+  bool SplitOnce(Partition *p) {
+    for (size_t splitter = 0; splitter != p->cell_ends.size(); splitter++) {
+      std::fill(splitter_.begin(), splitter_.end(), 0);
+      for (Graph::OrderTy i = p->GetCellBegin(splitter),
+                          e = p->cell_ends[splitter];
+           i != e; i++)
+        bitset::Set(splitter_, p->vertices[i]);
+
+      for (size_t cell = 0; cell != p->cell_ends.size(); cell++) {
+        Graph::OrderTy begin = p->GetCellBegin(cell), end = p->cell_ends[cell];
+        if (end - begin == 1)
+          continue;
+
+        counts_.clear();
+        for (Graph::OrderTy i = begin; i != end; i++) {
+          Graph::VertexTy v = p->vertices[i];
+          counts_.push_back(
+              {bitset::CountIntersection(GetRow(v), splitter_), v});
+        }
+        std::sort(counts_.begin(), counts_.end());
+        if (counts_.front().first == counts_.back().first)
+          continue;
+
+        std::vector<Graph::OrderTy> ends;
+        for (Graph::OrderTy i = 0; i != counts_.size(); i++) {
+          p->vertices[begin + i] = counts_[i].second;
+          if (i + 1 != counts_.size() &&
+              counts_[i].first != counts_[i + 1].first)
+            ends.push_back(begin + i + 1);
+        }
+        p->cell_ends.insert(p->cell_ends.begin() + cell, ends.begin(),
+                            ends.end());
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Search(Partition p) {
+    while (SplitOnce(&p)) {
+    }
+    if (p.IsDiscrete()) {
+      VisitLeaf(p);
+      return;
+    }
+
+    size_t target = 0;
+    while (p.cell_ends[target] - p.GetCellBegin(target) == 1)
+      target++;
+    Graph::OrderTy begin = p.GetCellBegin(target), end = p.cell_ends[target];
+    std::vector<Graph::VertexTy> candidates(p.vertices.begin() + begin,
+                                            p.vertices.begin() + end);
+    std::sort(candidates.begin(), candidates.end());
+
+    Graph::OrderTy depth = path_.size();
+    std::vector<Graph::VertexTy> explored;
+    for (Graph::VertexTy v : candidates) {
+      if (IsInOrbitOfAny(v, explored))
+        continue;
+      explored.push_back(v);
+
+      Partition child = p;
+      std::iter_swap(std::find(child.vertices.begin() + begin,
+                               child.vertices.begin() + end, v),
+                     child.vertices.begin() + begin);
+      child.cell_ends.insert(child.cell_ends.begin() + target, begin + 1);
+      path_.push_back(v);
+      Search(std::move(child));
+      path_.pop_back();
+
+      if (jump_depth_ < depth)
+        return;
+      jump_depth_ = kNoJump;
+    }
+  }
+
+  void VisitLeaf(const Partition &p) {
+    std::vector<Graph::VertexTy> labels(order_);
+    for (Graph::OrderTy i = 0; i != order_; i++)
+      labels[p.vertices[i]] = i;
+    std::vector<BitWord> form(rows_.size(), 0);
+    std::span<BitWord> words(form);
+    for (Graph::VertexTy v = 0; v != order_; v++) {
+      std::span<BitWord> row =
+          words.subspan(labels[v] * words_per_row_, words_per_row_);
+      for (Graph::VertexTy n : bitset::ElementRange(GetRow(v)))
+        bitset::Set(row, labels[n]);
+    }
+
+    if (!found_leaf_) {
+      found_leaf_ = true;
+      first_ = {path_, p.vertices, form};
+      best_ = {path_, p.vertices, std::move(form)};
+      return;
+    }
+
+    // A leaf with the matrix of an earlier one is its image under an
+    // automorphism.  If the automorphism also maps the path of the earlier
+    // leaf onto the current path, the subtree below where the paths part is
+    // the image of the one holding the earlier leaf, which the search has
+    // already finished.
+    for (const Leaf *leaf : {&first_, &best_}) {
+      if (form != leaf->form)
+        continue;
+      std::vector<Graph::VertexTy> automorphism(order_);
+      for (Graph::OrderTy i = 0; i != order_; i++)
+        automorphism[leaf->vertices[i]] = p.vertices[i];
+      bool maps_path = std::equal(
+          leaf->path.begin(), leaf->path.end(), path_.begin(), path_.end(),
+          [&](Graph::VertexTy a, Graph::VertexTy b) {
+            return automorphism[a] == b;
+          });
+      if (maps_path)
+        jump_depth_ = std::mismatch(path_.begin(), path_.end(),
+                                    leaf->path.begin(), leaf->path.end())
+                          .first -
+                      path_.begin();
+      automorphisms_.push_back(std::move(automorphism));
+      return;
+    }
+
+    if (form > best_.form)
+      best_ = {path_, p.vertices, std::move(form)};
+  }
+
+  // Whether an automorphism found so far that fixes every vertex on the
+  // current path maps some vertex of `explored` to `v`, possibly through a
+  // chain of such automorphisms.
+  bool IsInOrbitOfAny(Graph::VertexTy v,
+                      const std::vector<Graph::VertexTy> &explored) {
+    if (explored.empty() || automorphisms_.empty())
+      return false;
+
+    std::iota(parents_.begin(), parents_.end(), 0);
+    for (const std::vector<Graph::VertexTy> &automorphism : automorphisms_) {
+      if (std::all_of(path_.begin(), path_.end(), [&](Graph::VertexTy u) {
+            return automorphism[u] == u;
+          }))
+        JoinOrbits(automorphism);
+    }
+
+    Graph::VertexTy orbit = FindOrbit(v);
+    return std::any_of(
+        explored.begin(), explored.end(),
+        [&](Graph::VertexTy u) { return FindOrbit(u) == orbit; });
+  }
+
+  // `parents_` is a union-find forest whose roots are the least vertices of
+  // their trees.
+  Graph::VertexTy FindOrbit(Graph::VertexTy u) {
+    while (parents_[u] != u)
+      u = parents_[u] = parents_[parents_[u]];
+    return u;
+  }
+
+  void JoinOrbits(const std::vector<Graph::VertexTy> &automorphism) {
+    for (Graph::VertexTy u = 0; u != order_; u++) {
+      Graph::VertexTy a = FindOrbit(u), b = FindOrbit(automorphism[u]);
+      parents_[std::max(a, b)] = std::min(a, b);
+    }
+  }
+
+  std::span<const BitWord> GetRow(Graph::VertexTy v) const {
+    return rows_.subspan(v * words_per_row_, words_per_row_);
+  }
+
+  Graph::OrderTy order_;
+  size_t words_per_row_;
+  std::span<const BitWord> rows_;
+
+  std::vector<Graph::VertexTy> path_;
+  bool found_leaf_ = false;
+  Leaf first_;
+  Leaf best_;
+  std::vector<std::vector<Graph::VertexTy>> automorphisms_;
+  Graph::OrderTy jump_depth_ = kNoJump;
+
+  // Scratch space.
+  std::vector<BitWord> splitter_;
+  std::vector<std::pair<Graph::OrderTy, Graph::VertexTy>> counts_;
+  std::vector<Graph::VertexTy> parents_;
+};
+} // namespace
+
+std::vector<BitWord>
+ComputeCanonicalForm(Graph::OrderTy order, std::span<const BitWord> rows,
+                     std::vector<Graph::VertexTy> *labeling,
+                     std::vector<Graph::VertexTy> *orbits) {
+  CanonicalLabeler labeler(order, rows);
+  return labeler.Run(labeling, orbits);
+}
+
+std::vector<BitWord>
+ComputeCanonicalForm(Graph *g, std::vector<Graph::VertexTy> *labeling,
+                     std::vector<Graph::VertexTy> *orbits) {
+  if (const BitMatrixView *view = g->GetBitMatrixView()) {
+    Graph::OrderTy order = view->GetOrder();
+    std::vector<BitWord> rows;
+    for (Graph::VertexTy v = 0; v != order; v++) {
+      std::span<const BitWord> row = view->GetRow(v);
+      rows.insert(rows.end(), row.begin(), row.end());
+    }
+    return ComputeCanonicalForm(order, rows, labeling, orbits);
+  }
+  std::unique_ptr<BitMatrixGraph> copy = CreateBitMatrixGraph(g);
+  return ComputeCanonicalForm(copy->GetOrder(), copy->GetWords(), labeling,
+                              orbits);
+}
+} // namespace kb
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bitset.hpp"
+#include "graph.hpp"
+
+#include <span>
+#include <vector>
+
+namespace kb {
+// Returns the adjacency matrix of a graph relabeled so that two graphs get
+// equal matrices exactly if they are isomorphic.  Rows are packed like those
+// of a BitMatrixView, bitset::GetWordCount(order) words per vertex.  If
+// `labeling` is not null, it is set to the new label of every vertex.  If
+// `orbits` is not null, it is set to the least vertex of the orbit of every
+// vertex under the automorphism group.
+//
+// Like nauty, searches a tree of ordered vertex partitions: each node refines
+// its partition until every cell has the same number of neighbors in every
+// cell, and its children single out each vertex of the first cell with more
+// than one vertex.  The form is the largest matrix among the leaves.  Leaves
+// with equal matrices yield automorphisms, which prune children in the same
+// orbit and subtrees known to hold only equal matrices.
+std::vector<BitWord>
+ComputeCanonicalForm(Graph::OrderTy order, std::span<const BitWord> rows,
+                     std::vector<Graph::VertexTy> *labeling = nullptr,
+                     std::vector<Graph::VertexTy> *orbits = nullptr);
+
+std::vector<BitWord>
+ComputeCanonicalForm(Graph *g, std::vector<Graph::VertexTy> *labeling = nullptr,
+                     std::vector<Graph::VertexTy> *orbits = nullptr);
+} // namespace kb
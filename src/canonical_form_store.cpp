@@ -0,0 +1,233 @@
+#include "canonical_form_store.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace kb {
+namespace {
+std::atomic<unsigned long> NextStoreInstance = 0;
+
+constexpr size_t kInitialCapacity = 16;
+
+std::uint8_t GetFingerprint(std::uint64_t hash) {
+  return 1 + ((hash >> 51) & 0x7f);
+}
+
+// Packs the pairs (i, j) with i < j into consecutive bits, row by row.
+void PackUpperTriangle(Graph::OrderTy order, std::span<const BitWord> rows,
+                       std::span<BitWord> key) {
+  size_t words_per_row = bitset::GetWordCount(order);
+  std::fill(key.begin(), key.end(), 0);
+  size_t row_offset = 0;
+  for (Graph::VertexTy i = 0; i != order; i++) {
+    auto row = rows.subspan(i * words_per_row, words_per_row);
+    for (Graph::VertexTy j : bitset::ElementRange(row)) {
+      assert(j != i && "Canonical form stores do not support self loops");
+      if (j > i)
+        bitset::Set(key, row_offset + j - i - 1);
+    }
+    row_offset += order - i - 1;
+  }
+}
+} // namespace
+
+namespace detail {
+std::uint64_t HashPackedKey(std::span<const BitWord> key) {
+  std::uint64_t hash = 0x9e3779b97f4a7c15;
+  for (BitWord word : key) {
+    hash = (hash ^ word) * 0xbf58476d1ce4e5b9;
+    hash ^= hash >> 31;
+  }
+  return hash;
+}
+
+size_t PackedKeyTable::FindSlot(std::span<const BitWord> key,
+                                std::uint64_t hash) const {
+  std::uint8_t fingerprint = GetFingerprint(hash);
+  size_t mask = GetCapacity() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    if (fingerprints_[slot] == 0)
+      return slot;
+    if (fingerprints_[slot] == fingerprint &&
+        std::equal(key.begin(), key.end(), keys_.begin() + slot * key_words_))
+      return slot;
+  }
+}
+
+bool PackedKeyTable::Contains(std::span<const BitWord> key,
+                              std::uint64_t hash) const {
+  assert(key.size() == key_words_);
+  return GetCapacity() != 0 && fingerprints_[FindSlot(key, hash)] != 0;
+}
+
+bool PackedKeyTable::Insert(std::span<const BitWord> key, std::uint64_t hash) {
+  assert(key.size() == key_words_);
+  if (Contains(key, hash))
+    return false;
+  if (IsFull())
+    Grow();
+
+  size_t slot = FindSlot(key, hash);
+  fingerprints_[slot] = GetFingerprint(hash);
+  std::copy(key.begin(), key.end(), keys_.begin() + slot * key_words_);
+  size_++;
+  return true;
+}
+
+std::vector<BitWord> PackedKeyTable::GetKeys() const {
+  std::vector<BitWord> keys;
+  keys.reserve(size_ * key_words_);
+  for (size_t slot = 0; slot != GetCapacity(); slot++) {
+    if (fingerprints_[slot] != 0) {
+      auto key = keys_.begin() + slot * key_words_;
+      keys.insert(keys.end(), key, key + key_words_);
+    }
+  }
+  return keys;
+}
+
+void PackedKeyTable::Clear() {
+  keys_ = {};
+  fingerprints_ = {};
+  size_ = 0;
+}
+
+void PackedKeyTable::Grow() {
+  std::vector<BitWord> keys = GetKeys();
+  size_t capacity = std::max(kInitialCapacity, 2 * GetCapacity());
+  keys_.assign(capacity * key_words_, 0);
+  fingerprints_.assign(capacity, 0);
+  size_ = 0;
+  for (size_t i = 0; i != keys.size(); i += key_words_) {
+    std::span<const BitWord> key(keys.data() + i, key_words_);
+    Insert(key, HashPackedKey(key));
+  }
+}
+} // namespace detail
+
+CanonicalFormStore::CanonicalFormStore(Graph::OrderTy order,
+                                       CanonicalFormStoreOptions options)
+    : order_(order),
+      key_words_(std::max<size_t>(
+          1, bitset::GetWordCount(order * (order - (order != 0)) / 2))),
+      options_(std::move(options)), instance_(NextStoreInstance++) {
+  for (Shard &shard : shards_)
+    shard.table = detail::PackedKeyTable(key_words_);
+
+  if (options_.memory_limit != 0 && options_.spill_directory.empty()) {
+    std::error_code error;
+    options_.spill_directory =
+        std::filesystem::temp_directory_path(error).string();
+    if (error)
+      error_ = "Could not find a temporary directory to spill to: " +
+               error.message();
+  }
+}
+
+CanonicalFormStore::~CanonicalFormStore() {
+  for (size_t i = 0; i != shards_.size(); i++)
+    if (shards_[i].spilled)
+      std::remove(GetSpillPath(i).c_str());
+}
+
+bool CanonicalFormStore::Insert(std::span<const BitWord> rows) {
+  thread_local std::vector<BitWord> key;
+  key.resize(key_words_);
+  PackUpperTriangle(order_, rows, key);
+  std::uint64_t hash = detail::HashPackedKey(key);
+  size_t shard_index = hash >> (64 - kShardBits);
+  Shard &shard = shards_[shard_index];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.table.Contains(key, hash))
+    return false;
+
+  // Growing doubles the table.
+  size_t memory_usage = shard.table.GetMemoryUsage();
+  if (options_.memory_limit != 0 && shard.table.IsFull() &&
+      memory_usage_ + memory_usage > options_.memory_limit && !HasFailed()) {
+    // Only the shard is locked while its file is written, so that shards
+    // spill concurrently.
+    if (auto error = Spill(shard_index, &shard)) {
+      std::lock_guard<std::mutex> error_lock(error_mutex_);
+      if (!error_)
+        error_ = std::move(error);
+    } else {
+      memory_usage_ -= memory_usage;
+      memory_usage = 0;
+    }
+  }
+
+  bool inserted = shard.table.Insert(key, hash);
+  memory_usage_ += shard.table.GetMemoryUsage() - memory_usage;
+  return inserted;
+}
+
+SizeOrError CanonicalFormStore::CountDistinct() {
+  if (error_)
+    return *error_;
+
+  size_t count = 0;
+  for (size_t i = 0; i != shards_.size(); i++) {
+    Shard &shard = shards_[i];
+    if (!shard.spilled) {
+      count += shard.table.GetSize();
+      continue;
+    }
+
+    std::string path = GetSpillPath(i);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+      return "Could not open " + path;
+    std::vector<BitWord> keys(in.tellg() / sizeof(BitWord));
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(keys.data()),
+            keys.size() * sizeof(BitWord));
+    if (!in.good() || keys.size() % key_words_ != 0)
+      return "Could not read " + path;
+
+    std::vector<BitWord> in_memory = shard.table.GetKeys();
+    keys.insert(keys.end(), in_memory.begin(), in_memory.end());
+    detail::PackedKeyTable distinct(key_words_);
+    for (size_t j = 0; j != keys.size(); j += key_words_) {
+      std::span<const BitWord> key(keys.data() + j, key_words_);
+      distinct.Insert(key, detail::HashPackedKey(key));
+    }
+    count += distinct.GetSize();
+  }
+  return count;
+}
+
+bool CanonicalFormStore::HasFailed() {
+  std::lock_guard<std::mutex> lock(error_mutex_);
+  return error_.has_value();
+}
+
+std::string CanonicalFormStore::GetSpillPath(size_t shard) const {
+  return options_.spill_directory + "/canonical_forms." +
+         std::to_string(getpid()) + "." + std::to_string(instance_) + "." +
+         std::to_string(shard);
+}
+
+std::optional<std::string> CanonicalFormStore::Spill(size_t shard_index,
+                                                     Shard *shard) {
+  std::string path = GetSpillPath(shard_index);
+  auto mode = shard->spilled ? std::ios::app : std::ios::trunc;
+  std::ofstream out(path, std::ios::binary | mode);
+  if (!out.is_open())
+    return "Could not open " + path + " for writing";
+  shard->spilled = true;
+
+  std::vector<BitWord> keys = shard->table.GetKeys();
+  out.write(reinterpret_cast<const char *>(keys.data()),
+            keys.size() * sizeof(BitWord));
+  if (!out.good())
+    return "Could not write " + path;
+  shard->table.Clear();
+  return std::nullopt;
+}
+} // namespace kb
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "bitset.hpp"
+#include "graph.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace kb {
+struct CanonicalFormStoreOptions {
+  // Once the tables take more than this many bytes, a shard that needs to
+  // grow is written to a file in `spill_directory` and emptied instead.  Zero
+  // keeps every form in memory.
+  size_t memory_limit = 0;
+
+  // Empty for the system's temporary directory.
+  std::string spill_directory;
+};
+
+using SizeOrError = std::variant<size_t, std::string>;
+
+namespace detail {
+std::uint64_t HashPackedKey(std::span<const BitWord> key);
+
+// An open addressed set of keys of `key_words` words, probed linearly.  Each
+// slot has a one byte fingerprint taken from the hash, zero if the slot is
+// empty, so a probe compares whole keys only when the fingerprints match.
+class PackedKeyTable {
+public:
+  explicit PackedKeyTable(size_t key_words = 0) : key_words_(key_words) {}
+
+  // Returns false if `key` is already in the table, without growing it.
+  // `hash` must be HashPackedKey(key).
+  bool Insert(std::span<const BitWord> key, std::uint64_t hash);
+
+  bool Contains(std::span<const BitWord> key, std::uint64_t hash) const;
+
+  // Whether the next insertion of a new key would grow the table.
+  bool IsFull() const { return (size_ + 1) * 8 > GetCapacity() * 7; }
+
+  size_t GetSize() const { return size_; }
+  size_t GetCapacity() const { return fingerprints_.size(); }
+  size_t GetMemoryUsage() const {
+    return keys_.size() * sizeof(BitWord) + fingerprints_.size();
+  }
+
+  // The keys of the occupied slots, one after the other.
+  std::vector<BitWord> GetKeys() const;
+
+  // Empties the table and frees its memory.
+  void Clear();
+
+private:
+  // The slot holding `key`, or else the empty slot ending its probe sequence.
+  // The table must not be empty.
+  size_t FindSlot(std::span<const BitWord> key, std::uint64_t hash) const;
+
+  void Grow();
+
+  size_t key_words_;
+  std::vector<BitWord> keys_;
+  std::vector<std::uint8_t> fingerprints_;
+  size_t size_ = 0;
+};
+} // namespace detail
+
+// A set of canonical forms of loopless graphs of one order, which several
+// threads can insert into at once.  A form is stored as the upper triangle of
+// its adjacency matrix, without the diagonal, packed into GetKeyWords() words.
+// The keys live in open addressed tables with a one byte fingerprint of the
+// hash per slot, so that probes rarely compare whole keys, and the tables are
+// split by hash into shards that are locked independently.
+class CanonicalFormStore {
+public:
+  explicit CanonicalFormStore(Graph::OrderTy order,
+                              CanonicalFormStoreOptions options = {});
+
+  // Removes the spill files.
+  ~CanonicalFormStore();
+
+  CanonicalFormStore(const CanonicalFormStore &) = delete;
+  CanonicalFormStore &operator=(const CanonicalFormStore &) = delete;
+
+  // Adds a form given as rows packed like those of a BitMatrixView.  Returns
+  // false if the form is already in memory, in which case nothing grows or
+  // spills.  Spill files are not searched: a form only on disk is added
+  // again and Insert returns true, so once a shard has spilled the return
+  // value may overcount.  Only CountDistinct, which merges the files, is
+  // exact.
+  bool Insert(std::span<const BitWord> rows);
+
+  // Returns the number of distinct forms inserted, reading spilled shards
+  // back one at a time, or why a spill file could not be written or read.
+  // Must not run concurrently with Insert.
+  SizeOrError CountDistinct();
+
+  // The bytes held by the tables.
+  size_t GetMemoryUsage() const { return memory_usage_; }
+
+  size_t GetKeyWords() const { return key_words_; }
+
+private:
+  static constexpr unsigned kShardBits = 6;
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    detail::PackedKeyTable table;
+    bool spilled = false;
+  };
+
+  // Whether a spill has failed, after which nothing more is spilled.
+  bool HasFailed();
+
+  std::string GetSpillPath(size_t shard) const;
+
+  // Appends the keys of `shard` to its spill file and empties it.  Returns an
+  // error message on failure, leaving the keys in memory.
+  std::optional<std::string> Spill(size_t shard_index, Shard *shard);
+
+  Graph::OrderTy order_;
+  size_t key_words_;
+  CanonicalFormStoreOptions options_;
+  unsigned long instance_;
+  std::array<Shard, 1 << kShardBits> shards_;
+  std::atomic<size_t> memory_usage_ = 0;
+
+  // The first spill error, after which nothing more is spilled.
+  std::mutex error_mutex_;
+  std::optional<std::string> error_;
+};
+} // namespace kb
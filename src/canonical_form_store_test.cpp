@@ -0,0 +1,157 @@
+#include "canonical_form_store.hpp"
+
+#include "canonical.hpp"
+#include "graph_zoo.hpp"
+#include "test.hpp"
+
+#include <filesystem>
+#include <optional>
+
+using namespace kb;
+
+// Rows of a graph on `order` vertices whose first edges, in lexicographic
+// order, are picked by the bits of `index`, so distinct indices give distinct
+// rows.
+static std::vector<BitWord> CreateIndexedRows(Graph::OrderTy order,
+                                              unsigned long index) {
+  size_t words_per_row = bitset::GetWordCount(order);
+  std::vector<BitWord> rows(order * words_per_row, 0);
+  std::span<BitWord> words(rows);
+  for (Graph::VertexTy i = 0; index != 0 && i != order; i++) {
+    for (Graph::VertexTy j = i + 1; index != 0 && j != order; j++) {
+      if (index & 1) {
+        bitset::Set(words.subspan(i * words_per_row, words_per_row), j);
+        bitset::Set(words.subspan(j * words_per_row, words_per_row), i);
+      }
+      index >>= 1;
+    }
+  }
+  return rows;
+}
+
+static std::optional<size_t> GetDistinctCount(CanonicalFormStore *store) {
+  SizeOrError count = store->CountDistinct();
+  if (auto *error = std::get_if<std::string>(&count)) {
+    std::cerr << *error << std::endl;
+    return std::nullopt;
+  }
+  return std::get<size_t>(count);
+}
+
+static void TestCanonicalFormStore_Duplicates() {
+  CanonicalFormStore store(16);
+  CHECK_EQ(store.GetKeyWords(), 2);
+  std::vector<std::unique_ptr<Graph>> graphs;
+  graphs.push_back(CreateRingGraph(16));
+  graphs.push_back(CreateCompleteGraph(16, false));
+  graphs.push_back(CreateCompleteBipartiteGraph(8, 8));
+  graphs.push_back(CreateUnconnectedGraph(16));
+  for (const std::unique_ptr<Graph> &g : graphs)
+    CHECK(store.Insert(ComputeCanonicalForm(g.get())));
+  for (const std::unique_ptr<Graph> &g : graphs)
+    CHECK(!store.Insert(ComputeCanonicalForm(g.get())));
+
+  std::optional<size_t> count = GetDistinctCount(&store);
+  CHECK(count.has_value());
+  CHECK_EQ(*count, 4);
+}
+
+static void TestCanonicalFormStore_MemoryPerForm() {
+  // An unordered set of 16 row vectors took over 200 bytes per form.  Packed
+  // keys take 16 bytes and a fingerprint, in tables at least 7/16 full.
+  CanonicalFormStore store(16);
+  constexpr unsigned long kForms = 20000;
+  for (unsigned long i = 0; i != kForms; i++)
+    CHECK(store.Insert(CreateIndexedRows(16, i)));
+  CHECK_LE(store.GetMemoryUsage(), kForms * 40);
+
+  std::optional<size_t> count = GetDistinctCount(&store);
+  CHECK(count.has_value());
+  CHECK_EQ(*count, kForms);
+}
+
+static void TestCanonicalFormStore_Spill() {
+  CanonicalFormStore store(
+      12, {.memory_limit = 4096,
+           .spill_directory = std::filesystem::temp_directory_path()});
+  constexpr unsigned long kForms = 5000;
+  for (int pass = 0; pass != 2; pass++)
+    for (unsigned long i = 0; i != kForms; i++)
+      store.Insert(CreateIndexedRows(12, i));
+  CHECK_LT(store.GetMemoryUsage(), kForms * 9);
+
+  std::optional<size_t> count = GetDistinctCount(&store);
+  CHECK(count.has_value());
+  CHECK_EQ(*count, kForms);
+}
+
+static void TestPackedKeyTable_DuplicateDoesNotGrow() {
+  detail::PackedKeyTable table(1);
+  BitWord key = 0;
+  CHECK(table.Insert({&key, 1}, detail::HashPackedKey({&key, 1})));
+  key++;
+  while (!table.IsFull()) {
+    CHECK(table.Insert({&key, 1}, detail::HashPackedKey({&key, 1})));
+    key++;
+  }
+  size_t capacity = table.GetCapacity();
+  BitWord first = 0;
+  CHECK(!table.Insert({&first, 1}, detail::HashPackedKey({&first, 1})));
+  CHECK_EQ(table.GetCapacity(), capacity);
+  CHECK(table.Insert({&key, 1}, detail::HashPackedKey({&key, 1})));
+  CHECK_GT(table.GetCapacity(), capacity);
+}
+
+static void TestCanonicalFormStore_InsertAfterSpill() {
+  CanonicalFormStore store(
+      12, {.memory_limit = 64 * 1024,
+           .spill_directory = std::filesystem::temp_directory_path()});
+  constexpr unsigned long kForms = 5000;
+  for (unsigned long i = 0; i != kForms; i++)
+    CHECK(store.Insert(CreateIndexedRows(12, i)));
+
+  // Forms still in memory are reported as seen, and the ones only on disk
+  // are added again and reported as new.  The merged count stays exact.
+  // Going backwards meets the forms inserted last, still in memory, first.
+  unsigned long reported_new = 0;
+  for (unsigned long i = kForms; i-- != 0;)
+    reported_new += store.Insert(CreateIndexedRows(12, i));
+  CHECK_GT(reported_new, 0);
+  CHECK_LT(reported_new, kForms);
+
+  std::optional<size_t> count = GetDistinctCount(&store);
+  CHECK(count.has_value());
+  CHECK_EQ(*count, kForms);
+}
+
+static void TestCanonicalFormStore_SpillToTemporaryDirectory() {
+  CanonicalFormStore store(12, {.memory_limit = 4096});
+  constexpr unsigned long kForms = 5000;
+  for (unsigned long i = 0; i != kForms; i++)
+    store.Insert(CreateIndexedRows(12, i));
+  CHECK_LT(store.GetMemoryUsage(), kForms * 9);
+
+  std::optional<size_t> count = GetDistinctCount(&store);
+  CHECK(count.has_value());
+  CHECK_EQ(*count, kForms);
+}
+
+static void TestCanonicalFormStore_SpillError() {
+  CanonicalFormStore store(
+      12, {.memory_limit = 1, .spill_directory = "/nonexistent/directory"});
+  for (unsigned long i = 0; i != 1000; i++)
+    store.Insert(CreateIndexedRows(12, i));
+  CHECK(std::holds_alternative<std::string>(store.CountDistinct()));
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestPackedKeyTable_DuplicateDoesNotGrow)                                   \
+  F(TestCanonicalFormStore_Duplicates)                                         \
+  F(TestCanonicalFormStore_MemoryPerForm)                                      \
+  F(TestCanonicalFormStore_Spill)                                              \
+  F(TestCanonicalFormStore_InsertAfterSpill)                                   \
+  F(TestCanonicalFormStore_SpillToTemporaryDirectory)                          \
+  F(TestCanonicalFormStore_SpillError)                                         \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,104 @@
+#include "canonical.hpp"
+
+#include "bit_matrix_graph.hpp"
+#include "graph_zoo.hpp"
+#include "random_graph.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace kb;
+
+// Checks that a random relabeling of `g` has the same canonical form, and that
+// the labeling returned turns `g` into its form.
+static void CheckCanonicalForm(Graph *g, unsigned seed) {
+  std::unique_ptr<BitMatrixGraph> matrix = CreateBitMatrixGraph(g);
+  std::vector<Graph::VertexTy> permutation(g->GetOrder());
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::mt19937 rng(seed);
+  std::shuffle(permutation.begin(), permutation.end(), rng);
+  std::unique_ptr<BitMatrixGraph> permuted = matrix->Permute(permutation);
+
+  std::vector<Graph::VertexTy> labeling;
+  std::vector<BitWord> form = ComputeCanonicalForm(matrix.get(), &labeling);
+  CHECK(ComputeCanonicalForm(permuted.get()) == form);
+  std::unique_ptr<BitMatrixGraph> relabeled = matrix->Permute(labeling);
+  CHECK(std::ranges::equal(relabeled->GetWords(), form));
+  CHECK(ComputeCanonicalForm(g) == form);
+}
+
+static void TestCanonicalForm_RandomGraphs() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  unsigned seed = 0;
+  for (Graph::OrderTy order : {1, 2, 10, 30, 70}) {
+    std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), order, 3);
+    CheckCanonicalForm(g.get(), seed++);
+  }
+}
+
+static void TestCanonicalForm_SymmetricGraphs() {
+  // Without automorphism pruning these would need up to 8! * 8! * 2 leaves.
+  std::unique_ptr<Graph> bipartite = CreateCompleteBipartiteGraph(8, 8);
+  CheckCanonicalForm(bipartite.get(), 1);
+
+  std::unique_ptr<Graph> complete_graph = CreateCompleteGraph(12, true);
+  CheckCanonicalForm(complete_graph.get(), 2);
+
+  std::unique_ptr<Graph> ring_graph = CreateRingGraph(40);
+  CheckCanonicalForm(ring_graph.get(), 3);
+
+  std::unique_ptr<Graph> product = CreateReplacementProduct(
+      CreateCompleteGraph(7, false), CreateRingGraph(6));
+  CheckCanonicalForm(product.get(), 4);
+
+  std::unique_ptr<Graph> empty_graph = CreateUnconnectedGraph(20);
+  CheckCanonicalForm(empty_graph.get(), 5);
+}
+
+static void TestCanonicalForm_DistinguishesGraphs() {
+  // A hexagon and two triangles are both 2-regular.
+  std::vector<Graph::EdgeTy> hexagon = {{0, 1}, {1, 2}, {2, 3},
+                                        {3, 4}, {4, 5}, {5, 0}};
+  std::vector<Graph::EdgeTy> triangles = {{0, 1}, {1, 2}, {2, 0},
+                                          {3, 4}, {4, 5}, {5, 3}};
+  CHECK(ComputeCanonicalForm(CreateBitMatrixGraph(6, hexagon).get()) !=
+        ComputeCanonicalForm(CreateBitMatrixGraph(6, triangles).get()));
+
+  // K_{3,3} and the triangular prism are both 3-regular.
+  std::vector<Graph::EdgeTy> prism = triangles;
+  for (Graph::VertexTy v = 0; v < 3; v++)
+    prism.push_back({v, v + 3});
+  std::unique_ptr<Graph> bipartite = CreateCompleteBipartiteGraph(3, 3);
+  CHECK(ComputeCanonicalForm(CreateBitMatrixGraph(6, prism).get()) !=
+        ComputeCanonicalForm(bipartite.get()));
+}
+
+static void TestCanonicalForm_Orbits() {
+  // The ends of a path and its inner vertices.
+  std::vector<Graph::EdgeTy> path = {{0, 1}, {1, 2}, {2, 3}};
+  std::vector<Graph::VertexTy> orbits;
+  ComputeCanonicalForm(CreateBitMatrixGraph(4, path).get(), nullptr, &orbits);
+  std::vector<Graph::VertexTy> expected_orbits = {0, 1, 1, 0};
+  CHECK(orbits == expected_orbits);
+
+  std::unique_ptr<Graph> bipartite = CreateCompleteBipartiteGraph(3, 5);
+  ComputeCanonicalForm(bipartite.get(), nullptr, &orbits);
+  expected_orbits = {0, 0, 0, 3, 3, 3, 3, 3};
+  CHECK(orbits == expected_orbits);
+
+  std::unique_ptr<Graph> ring_graph = CreateRingGraph(30);
+  ComputeCanonicalForm(ring_graph.get(), nullptr, &orbits);
+  CHECK(std::ranges::count(orbits, 0) == 30);
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestCanonicalForm_RandomGraphs)                                            \
+  F(TestCanonicalForm_SymmetricGraphs)                                         \
+  F(TestCanonicalForm_DistinguishesGraphs)                                     \
+  F(TestCanonicalForm_Orbits)                                                  \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -1,29 +1,83 @@
 #include "counting.hpp"
 
+#include "bitset.hpp"
+#include "canonical.hpp"
 #include "logging.hpp"
+#include "parallel.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
-#include <numeric>
-#include <set>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace kb {
 namespace {
+struct BitWordsHash {
+  size_t operator()(const std::vector<BitWord> &words) const {
+    size_t hash = words.size();
+    for (BitWord word : words)
+      hash = (hash ^ word) * 0x9e3779b97f4a7c15ul;
+    return hash;
+  }
+};
+
+// Subtrees of the searches below are handed to idle workers only if at least
+// this many more edges, or vertices, are left to add.
+constexpr unsigned long kMinSpawnedEdges = 8;
+constexpr Graph::OrderTy kMinSpawnedVertices = 4;
+
+// Enumerates the labeled regular graphs edge by edge in lexicographic order
+// and keeps one canonical form per isomorphism class.  No vertex gets more
+// than `degree` neighbors, and a prefix is abandoned as soon as a vertex that
+// no later edge can touch is short of neighbors.  There is one counter per
+// worker, sharing the store of forms.
 class GraphCounter {
 public:
-  GraphCounter(unsigned order, unsigned degree)
-      : order_(order), degree_(degree) {
-    num_neighbors_.reset(new unsigned[order_]);
+  // The edges chosen so far, and the first edge that may be chosen next.
+  struct Subtree {
+    std::vector<std::pair<unsigned, unsigned>> edges;
+    std::pair<unsigned, unsigned> start = {0, 1};
+  };
+
+  GraphCounter(unsigned order, unsigned degree,
+               std::vector<GraphCounter> *workers,
+               CanonicalFormStore *unique_graphs)
+      : workers_(workers), unique_graphs_(unique_graphs), order_(order),
+        degree_(degree) {
+    num_neighbors_.reset(new unsigned[order_]());
     assert((degree_ * order_) % 2 == 0);
     max_edges_ = (degree_ * order_) / 2;
     edges_.reset(new std::pair<unsigned, unsigned>[max_edges_]);
   }
 
-  unsigned long Count() {
-    RecursivelyAddEdge();
-    return unique_graphs_.size();
+  void Run(const Subtree &subtree, unsigned worker, TaskQueue *queue) {
+    worker_ = worker;
+    queue_ = queue;
+    std::fill_n(num_neighbors_.get(), order_, 0);
+    for (size_t i = 0; i != subtree.edges.size(); i++) {
+      edges_[i] = subtree.edges[i];
+      num_neighbors_[edges_[i].first]++;
+      num_neighbors_[edges_[i].second]++;
+    }
+    RecursivelyAddEdge(subtree.edges.size(), subtree.start);
+  }
+
+  static TaskQueue::Task MakeTask(std::vector<GraphCounter> *workers,
+                                  Subtree subtree) {
+    return [workers, subtree = std::move(subtree)](unsigned worker,
+                                                   TaskQueue *queue) {
+      (*workers)[worker].Run(subtree, worker, queue);
+    };
   }
 
 private:
@@ -40,87 +94,477 @@ private:
     return e.first == order_ - 1;
   }
 
-  bool IsGraphRegular() {
-    for (unsigned i = 0; i < order_; i++)
-      num_neighbors_[i] = 0;
-    for (int i = 0; i < max_edges_; i++) {
-      num_neighbors_[edges_[i].first]++;
-      num_neighbors_[edges_[i].second]++;
-    }
-
-    for (unsigned i = 0; i < order_; i++)
-      if (num_neighbors_[i] != degree_)
-        return false;
-    return true;
-  }
-
-  void GetEdgesAsBitset(std::vector<bool> *result,
-                        const std::vector<int> &permutation) {
-    result->assign(order_ * order_, false);
+  // Packs the adjacency matrix into one row of words per vertex.
+  void GetEdgesAsBitset(std::vector<BitWord> *result) {
+    size_t words_per_row = bitset::GetWordCount(order_);
+    result->assign(order_ * words_per_row, 0);
+    std::span<BitWord> words(*result);
     for (int i = 0; i < max_edges_; i++) {
-      std::pair<unsigned, unsigned> e = {permutation[edges_[i].first],
-                                         permutation[edges_[i].second]};
-      (*result)[e.first * order_ + e.second] = true;
-      (*result)[e.second * order_ + e.first] = true;
+      auto [a, b] = edges_[i];
+      bitset::Set(words.subspan(a * words_per_row), b);
+      bitset::Set(words.subspan(b * words_per_row), a);
     }
   }
 
-  void CountGraphIfRegularAndUnique() {
-    if (!IsGraphRegular())
-      return;
-    std::vector<int> permutation(static_cast<int>(order_));
-    std::iota(permutation.begin(), permutation.end(), 0);
-
-    std::vector<bool> result(static_cast<int>(order_ * order_));
-    bool unique = true;
-    do {
-      GetEdgesAsBitset(&result, permutation);
-      if (unique_graphs_.count(result)) {
-        unique = false;
-        break;
-      }
-    } while (std::next_permutation(permutation.begin(), permutation.end()));
-
-    if (unique) {
-      auto inserted = unique_graphs_.insert(result).second;
-      assert(inserted);
-      (void)inserted;
-      if (IsLoggingEnabled()) {
-        std::cerr << "graph G {\n";
-        for (int i = 0; i < max_edges_; i++)
-          std::cerr << "  " << edges_[i].first << " -- " << edges_[i].second
-                    << "\n";
-        std::cerr << "}\n";
-      }
+  // The graph has degree * order / 2 edges and no vertex has more than
+  // `degree` neighbors, so it is regular.  The count is taken from the store
+  // at the end.  Once the store spills, Insert may report a form seen before,
+  // so a logged class may be logged again.
+  void CountGraphIfUnique() {
+    std::vector<BitWord> edges;
+    GetEdgesAsBitset(&edges);
+    bool unique = unique_graphs_->Insert(ComputeCanonicalForm(order_, edges));
+    if (unique && IsLoggingEnabled()) {
+      static std::mutex log_mutex;
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cerr << "graph G {\n";
+      for (int i = 0; i < max_edges_; i++)
+        std::cerr << "  " << edges_[i].first << " -- " << edges_[i].second
+                  << "\n";
+      std::cerr << "}\n";
     }
   }
 
   void RecursivelyAddEdge(int depth = 0,
                           std::pair<unsigned, unsigned> start = {0, 1}) {
     if (depth == max_edges_) {
-      CountGraphIfRegularAndUnique();
+      CountGraphIfUnique();
       return;
     }
 
     for (std::pair<unsigned, unsigned> i = start; !IsAtEnd(i); i = Incr(i)) {
+      // No edge from here on touches the vertices before `i.first`.
+      if (i.first != 0 && num_neighbors_[i.first - 1] != degree_)
+        return;
+      if (num_neighbors_[i.first] == degree_ ||
+          num_neighbors_[i.second] == degree_)
+        continue;
+
       edges_[depth] = i;
+      if (max_edges_ - depth > kMinSpawnedEdges && queue_->HasIdleWorkers()) {
+        Subtree subtree = {{edges_.get(), edges_.get() + depth + 1}, Incr(i)};
+        queue_->Push(worker_, MakeTask(workers_, std::move(subtree)));
+        continue;
+      }
+
+      num_neighbors_[i.first]++;
+      num_neighbors_[i.second]++;
       RecursivelyAddEdge(depth + 1, Incr(i));
+      num_neighbors_[i.first]--;
+      num_neighbors_[i.second]--;
     }
   }
 
+  std::vector<GraphCounter> *workers_;
+  CanonicalFormStore *unique_graphs_;
+  unsigned worker_ = 0;
+  TaskQueue *queue_ = nullptr;
+
   std::unique_ptr<unsigned[]> num_neighbors_;
   std::unique_ptr<std::pair<unsigned, unsigned>[]> edges_;
-  std::set<std::vector<bool>> unique_graphs_;
 
   unsigned long order_;
   unsigned long degree_;
   unsigned long max_edges_;
 };
+
+// Counts regular graphs by canonical augmentation, as in McKay's "Isomorph-free
+// exhaustive generation".  The graphs searched are those that can be the
+// subgraph induced by the first vertices of a regular graph of the target
+// order, and each is extended by one vertex joined to some of its vertices.
+// The parent of a graph is the graph without its canonical vertex, the one
+// with the largest canonical label among the vertices of largest degree.  An
+// extension is kept only if its new vertex is in the orbit of its canonical
+// vertex, and only once among isomorphic extensions of the same graph, so
+// every isomorphism class is reached exactly once and none are stored.  There
+// is one counter per worker, each counting the graphs of the subtrees it ran.
+class AugmentationCounter {
+public:
+  // A graph on the first vertices, one word per row.
+  struct Subtree {
+    std::vector<BitWord> rows;
+    std::vector<unsigned> degrees;
+  };
+
+  AugmentationCounter(unsigned order, unsigned degree,
+                      std::vector<AugmentationCounter> *workers)
+      : workers_(workers), order_(order), degree_(degree) {
+    assert(order_ <= kBitsPerWord);
+    assert((degree_ * order_) % 2 == 0);
+  }
+
+  void Run(const Subtree &subtree, unsigned worker, TaskQueue *queue) {
+    worker_ = worker;
+    queue_ = queue;
+    rows_ = subtree.rows;
+    degrees_ = subtree.degrees;
+    Extend();
+  }
+
+  static TaskQueue::Task MakeTask(std::vector<AugmentationCounter> *workers,
+                                  Subtree subtree) {
+    return [workers, subtree = std::move(subtree)](unsigned worker,
+                                                   TaskQueue *queue) {
+      (*workers)[worker].Run(subtree, worker, queue);
+    };
+  }
+
+  // Appends the graphs on `frontier_order` vertices below `subtree` to
+  // `frontier` in the order the search reaches them, without searching below
+  // them.  Runs on the calling thread.
+  void CollectFrontier(const Subtree &subtree, Graph::OrderTy frontier_order,
+                       std::vector<Subtree> *frontier) {
+    frontier_ = frontier;
+    frontier_order_ = frontier_order;
+    rows_ = subtree.rows;
+    degrees_ = subtree.degrees;
+    Extend();
+    frontier_ = nullptr;
+  }
+
+  unsigned long GetCount() const { return count_; }
+
+private:
+  // `rows_` and `degrees_` hold the current graph, one word per row.
+  void Extend() {
+    Graph::OrderTy size = rows_.size();
+    if (frontier_ && size == frontier_order_) {
+      frontier_->push_back({rows_, degrees_});
+      return;
+    }
+    if (size == order_) {
+      count_++;
+      return;
+    }
+
+    // After the new vertex, `remaining` more vertices must make up for every
+    // missing neighbor.  Vertices missing more than that must be joined to
+    // the new vertex, and the missing neighbors must pair up among the
+    // remaining vertices or be joined to the current ones.
+    Graph::OrderTy remaining = order_ - size - 1;
+    BitWord forced = 0;
+    std::vector<Graph::VertexTy> optional;
+    unsigned max_degree = 0;
+    unsigned long missing = 0;
+    for (Graph::VertexTy v = 0; v != size; v++) {
+      unsigned deficit = degree_ - degrees_[v];
+      if (deficit > remaining)
+        forced |= BitWord(1) << v;
+      else if (deficit != 0)
+        optional.push_back(v);
+      max_degree = std::max(max_degree, degrees_[v]);
+      missing += deficit;
+    }
+    if ((missing + degree_ - degree_ * remaining) % 2 != 0)
+      return;
+
+    // The new vertex must be of largest degree to be the canonical one, so
+    // vertices already of its degree cannot be joined to it.
+    unsigned forced_count = std::popcount(forced);
+    Extensions extensions;
+    for (unsigned new_degree = std::max(max_degree, forced_count);
+         new_degree <= degree_; new_degree++) {
+      if (degree_ - new_degree > remaining ||
+          missing + degree_ > degree_ * remaining + 2 * new_degree)
+        continue;
+      bool forced_ok = true;
+      for (Graph::VertexTy v : bitset::ElementRange({&forced, 1}))
+        forced_ok &= degrees_[v] < new_degree;
+      if (!forced_ok)
+        continue;
+
+      extensions.new_degree = new_degree;
+      extensions.candidates.clear();
+      for (Graph::VertexTy v : optional)
+        if (degrees_[v] < new_degree)
+          extensions.candidates.push_back(v);
+      ChooseNeighbors(forced, new_degree - forced_count, 0, &extensions);
+    }
+  }
+
+  // The extensions of one graph by vertices of degree `new_degree`, and the
+  // canonical forms of those kept so far.
+  struct Extensions {
+    unsigned new_degree = 0;
+    std::vector<Graph::VertexTy> candidates;
+    std::unordered_set<std::vector<BitWord>, BitWordsHash> children;
+  };
+
+  // Joins the new vertex to `neighbors` and `count` more of the candidates
+  // from `first` on, in every possible way.
+  void ChooseNeighbors(BitWord neighbors, unsigned count, size_t first,
+                       Extensions *extensions) {
+    if (count == 0) {
+      TryExtension(neighbors, extensions);
+      return;
+    }
+    const std::vector<Graph::VertexTy> &candidates = extensions->candidates;
+    for (size_t i = first; i + count <= candidates.size(); i++)
+      ChooseNeighbors(neighbors | BitWord(1) << candidates[i], count - 1,
+                      i + 1, extensions);
+  }
+
+  void TryExtension(BitWord neighbors, Extensions *extensions) {
+    Graph::VertexTy v = rows_.size();
+    rows_.push_back(neighbors);
+    degrees_.push_back(extensions->new_degree);
+    for (Graph::VertexTy n : bitset::ElementRange({&neighbors, 1})) {
+      rows_[n] |= BitWord(1) << v;
+      degrees_[n]++;
+    }
+
+    std::vector<Graph::VertexTy> labeling, orbits;
+    std::vector<BitWord> form =
+        ComputeCanonicalForm(v + 1, rows_, &labeling, &orbits);
+    Graph::VertexTy canonical = v;
+    for (Graph::VertexTy u = 0; u != v; u++)
+      if (degrees_[u] == extensions->new_degree &&
+          labeling[u] > labeling[canonical])
+        canonical = u;
+    if (orbits[canonical] == orbits[v] &&
+        extensions->children.insert(std::move(form)).second) {
+      if (!frontier_ && order_ - v > kMinSpawnedVertices &&
+          queue_->HasIdleWorkers())
+        queue_->Push(worker_, MakeTask(workers_, {rows_, degrees_}));
+      else
+        Extend();
+    }
+
+    for (Graph::VertexTy n : bitset::ElementRange({&neighbors, 1})) {
+      rows_[n] &= ~(BitWord(1) << v);
+      degrees_[n]--;
+    }
+    rows_.pop_back();
+    degrees_.pop_back();
+  }
+
+  std::vector<AugmentationCounter> *workers_;
+  unsigned worker_ = 0;
+  TaskQueue *queue_ = nullptr;
+
+  Graph::OrderTy order_;
+  unsigned degree_;
+  std::vector<BitWord> rows_;
+  std::vector<unsigned> degrees_;
+  unsigned long count_ = 0;
+
+  std::vector<Subtree> *frontier_ = nullptr;
+  Graph::OrderTy frontier_order_ = 0;
+};
+
+unsigned long CountAugmentations(
+    unsigned order, unsigned degree,
+    std::span<const AugmentationCounter::Subtree> subtrees) {
+  unsigned num_workers = GetDefaultConcurrency();
+  std::vector<AugmentationCounter> workers;
+  workers.reserve(num_workers);
+  for (unsigned worker = 0; worker != num_workers; worker++)
+    workers.emplace_back(order, degree, &workers);
+  std::vector<TaskQueue::Task> tasks;
+  for (const AugmentationCounter::Subtree &subtree : subtrees)
+    tasks.push_back(AugmentationCounter::MakeTask(&workers, subtree));
+  RunWithWorkStealing(num_workers, std::move(tasks));
+
+  unsigned long count = 0;
+  for (const AugmentationCounter &worker : workers)
+    count += worker.GetCount();
+  return count;
+}
+
+// The subtrees of the augmentation search that a checkpointed count runs in
+// batches: every graph on the least number of vertices that gives at least
+// kMinFrontierSize of them, in search order.  A checkpoint records a hash of
+// the canonical forms of the frontier in order, so that one written by a
+// build that splits the search differently is rejected rather than resumed
+// at the wrong subtree.
+constexpr size_t kMinFrontierSize = 1024;
+
+struct Frontier {
+  Graph::OrderTy order = 0;
+  std::vector<AugmentationCounter::Subtree> subtrees;
+  std::uint64_t hash = 0;
+};
+
+Frontier CollectFrontier(unsigned order, unsigned degree) {
+  Frontier frontier;
+  frontier.subtrees.emplace_back();
+  AugmentationCounter counter(order, degree, nullptr);
+  while (frontier.subtrees.size() < kMinFrontierSize &&
+         frontier.order != order) {
+    std::vector<AugmentationCounter::Subtree> next;
+    frontier.order++;
+    for (const AugmentationCounter::Subtree &subtree : frontier.subtrees)
+      counter.CollectFrontier(subtree, frontier.order, &next);
+    frontier.subtrees = std::move(next);
+  }
+
+  frontier.hash = frontier.subtrees.size();
+  for (const AugmentationCounter::Subtree &subtree : frontier.subtrees) {
+    std::vector<BitWord> form =
+        ComputeCanonicalForm(subtree.rows.size(), subtree.rows);
+    frontier.hash = (frontier.hash ^ BitWordsHash()(form)) * 0xff51afd7ed558ccd;
+  }
+  return frontier;
+}
+
+// How far a checkpointed count has got: the subtrees before `next` of a
+// frontier are finished and hold `count` graphs.
+struct Checkpoint {
+  unsigned order = 0;
+  unsigned degree = 0;
+  Graph::OrderTy frontier_order = 0;
+  size_t frontier_size = 0;
+  std::uint64_t frontier_hash = 0;
+  size_t next = 0;
+  unsigned long count = 0;
+};
+
+// Names the format, and its version.
+constexpr const char *kCheckpointMagic = "kb-regular-graph-count-v2";
+
+// Writes the checkpoint to a temporary file renamed over `path`, so that a
+// run stopped while writing leaves the previous checkpoint intact.
+std::optional<std::string> WriteCheckpoint(const Checkpoint &checkpoint,
+                                           const std::string &path) {
+  std::string temporary_path = path + ".tmp";
+  {
+    std::ofstream out(temporary_path);
+    if (!out.is_open())
+      return "Could not open " + temporary_path + " for writing";
+    out << kCheckpointMagic << "\n"
+        << checkpoint.order << " " << checkpoint.degree << " "
+        << checkpoint.frontier_order << " " << checkpoint.frontier_size << " "
+        << checkpoint.frontier_hash << " " << checkpoint.next << " "
+        << checkpoint.count << "\n";
+    out.close();
+    if (out.fail())
+      return "Could not write " + temporary_path;
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  if (error)
+    return "Could not rename " + temporary_path + ": " + error.message();
+  return std::nullopt;
+}
+
+// Reads the checkpoint at `path` into `checkpoint`, leaving it as it was if
+// there is no file.
+std::optional<std::string> ReadCheckpoint(const std::string &path,
+                                          Checkpoint *checkpoint) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    if (!std::filesystem::exists(path))
+      return std::nullopt;
+    return "Could not open " + path;
+  }
+  std::string magic;
+  in >> magic >> checkpoint->order >> checkpoint->degree >>
+      checkpoint->frontier_order >> checkpoint->frontier_size >>
+      checkpoint->frontier_hash >> checkpoint->next >> checkpoint->count;
+  if (!in || magic != kCheckpointMagic ||
+      checkpoint->next > checkpoint->frontier_size)
+    return path + " is not a regular graph count checkpoint";
+  return std::nullopt;
+}
+
+// Runs the frontier in batches sized to take about one checkpoint interval,
+// resuming from and updating the checkpoint file if there is one.
+CountOrError CountWithCheckpoints(unsigned order, unsigned degree,
+                                  const RegularGraphCountingOptions &options) {
+  Frontier frontier = CollectFrontier(order, degree);
+  Checkpoint checkpoint = {.order = order,
+                           .degree = degree,
+                           .frontier_order = frontier.order,
+                           .frontier_size = frontier.subtrees.size(),
+                           .frontier_hash = frontier.hash};
+  const std::string &path = options.checkpoint_path;
+  if (!path.empty()) {
+    Checkpoint expected = checkpoint;
+    if (auto error = ReadCheckpoint(path, &checkpoint))
+      return *error;
+    if (checkpoint.order != expected.order ||
+        checkpoint.degree != expected.degree ||
+        checkpoint.frontier_order != expected.frontier_order ||
+        checkpoint.frontier_size != expected.frontier_size ||
+        checkpoint.frontier_hash != expected.frontier_hash)
+      return path + " is the checkpoint of a different count";
+  }
+
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  unsigned long counted = 0;
+  size_t batch_size = GetDefaultConcurrency();
+  while (checkpoint.next != checkpoint.frontier_size) {
+    size_t end =
+        std::min(checkpoint.frontier_size, checkpoint.next + batch_size);
+    Clock::time_point batch_start = Clock::now();
+    unsigned long count = CountAugmentations(
+        order, degree,
+        std::span(frontier.subtrees).subspan(checkpoint.next,
+                                              end - checkpoint.next));
+    Clock::duration batch_time = Clock::now() - batch_start;
+    checkpoint.next = end;
+    checkpoint.count += count;
+    counted += count;
+
+    if (!path.empty())
+      if (auto error = WriteCheckpoint(checkpoint, path))
+        return *error;
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    RegularGraphCountingProgress progress = {
+        .finished_subtrees = checkpoint.next,
+        .total_subtrees = checkpoint.frontier_size,
+        .count = checkpoint.count,
+        .elapsed_seconds = elapsed.count(),
+        .graphs_per_second = counted / std::max(elapsed.count(), 1e-9)};
+    LOG << "Finished " << progress.finished_subtrees << " of "
+        << progress.total_subtrees << " subtrees, " << progress.count
+        << " graphs, " << progress.graphs_per_second << " graphs/s"
+        << std::endl;
+    if (options.progress && !options.progress(progress) &&
+        checkpoint.next != checkpoint.frontier_size)
+      return "Stopped after " + std::to_string(checkpoint.next) + " of " +
+             std::to_string(checkpoint.frontier_size) + " subtrees";
+
+    if (batch_time < options.checkpoint_interval / 2)
+      batch_size *= 2;
+    else if (batch_time > options.checkpoint_interval * 2 && batch_size > 1)
+      batch_size /= 2;
+  }
+  return checkpoint.count;
+}
 } // namespace
 
-unsigned long CountRegularGraphsWithDegree(unsigned order, unsigned degree) {
+CountOrError
+CountRegularGraphsWithDegree(unsigned order, unsigned degree,
+                             const RegularGraphCountingOptions &options) {
   assert(order > degree);
-  GraphCounter gc(order, degree);
-  return gc.Count();
+  unsigned num_workers = GetDefaultConcurrency();
+  switch (options.method) {
+  case RegularGraphCountingMethod::kCanonicalAugmentation: {
+    if (!options.checkpoint_path.empty() || options.progress)
+      return CountWithCheckpoints(order, degree, options);
+    AugmentationCounter::Subtree root;
+    return CountAugmentations(order, degree, {&root, 1});
+  }
+  case RegularGraphCountingMethod::kCanonicalFormSet: {
+    if (!options.checkpoint_path.empty() || options.progress)
+      return "Checkpoints and progress need kCanonicalAugmentation";
+    CanonicalFormStore unique_graphs(order, options.form_store);
+    std::vector<GraphCounter> workers;
+    workers.reserve(num_workers);
+    for (unsigned worker = 0; worker != num_workers; worker++)
+      workers.emplace_back(order, degree, &workers, &unique_graphs);
+    std::vector<TaskQueue::Task> tasks;
+    tasks.push_back(GraphCounter::MakeTask(&workers, {}));
+    RunWithWorkStealing(num_workers, std::move(tasks));
+    SizeOrError size = unique_graphs.CountDistinct();
+    if (auto *error = std::get_if<std::string>(&size))
+      return *error;
+    return std::get<size_t>(size);
+  }
+  }
+  return 0ul;
 }
 } // namespace kb
@@ -1,5 +1,62 @@
 #pragma once
 
+#include "canonical_form_store.hpp"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <variant>
+
 namespace kb {
-unsigned long CountRegularGraphsWithDegree(unsigned order, unsigned degree);
-}
+enum class RegularGraphCountingMethod {
+  // Builds the graphs one vertex at a time, keeping each isomorphism class of
+  // partial graph once, so nothing is stored.  Orders up to 64.
+  kCanonicalAugmentation,
+  // Enumerates every labeled regular graph and stores one canonical form per
+  // isomorphism class in a CanonicalFormStore.  Far slower, and kept to check
+  // the other method.
+  kCanonicalFormSet,
+};
+
+struct RegularGraphCountingProgress {
+  // The search is split into subtrees that are run in batches.
+  size_t finished_subtrees = 0;
+  size_t total_subtrees = 0;
+  // The graphs found in the finished subtrees, including those of the runs
+  // that wrote the checkpoint resumed from.
+  unsigned long count = 0;
+  // Since the start of this run.
+  double elapsed_seconds = 0;
+  double graphs_per_second = 0;
+};
+
+struct RegularGraphCountingOptions {
+  RegularGraphCountingMethod method =
+      RegularGraphCountingMethod::kCanonicalAugmentation;
+  // Where kCanonicalFormSet keeps its forms.
+  CanonicalFormStoreOptions form_store;
+
+  // If not empty, kCanonicalAugmentation writes here after every batch of
+  // subtrees how many are finished and the graphs they hold, and resumes from
+  // the file if it exists.  The file is kept once the count is done, so
+  // running again returns the count.
+  std::string checkpoint_path;
+  // Batches are sized to take about this long.
+  std::chrono::milliseconds checkpoint_interval = std::chrono::minutes(1);
+  // Called after every batch, once the checkpoint is written.  Returning
+  // false stops the count with an error, to be resumed later.  Progress is
+  // also logged if logging is enabled.
+  std::function<bool(const RegularGraphCountingProgress &)> progress;
+};
+
+using CountOrError = std::variant<unsigned long, std::string>;
+
+// Counts the regular graphs of the given order and degree up to isomorphism,
+// connected or not.  The search is spread over GetDefaultConcurrency()
+// threads, which steal subtrees from each other.  Fails if the form store
+// cannot spill, or the checkpoint cannot be read or written, or the progress
+// callback stops the count.
+CountOrError
+CountRegularGraphsWithDegree(unsigned order, unsigned degree,
+                             const RegularGraphCountingOptions &options = {});
+} // namespace kb
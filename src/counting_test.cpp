@@ -1,26 +1,155 @@
 #include "counting.hpp"
 
 #include "logging.hpp"
+#include "parallel.hpp"
 #include "test.hpp"
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include <utility>
+
 using namespace kb;
 
+static unsigned long
+CountOrZero(unsigned order, unsigned degree,
+            const RegularGraphCountingOptions &options = {}) {
+  CountOrError count = CountRegularGraphsWithDegree(order, degree, options);
+  if (auto *error = std::get_if<std::string>(&count)) {
+    std::cerr << *error << std::endl;
+    return 0;
+  }
+  return std::get<unsigned long>(count);
+}
+
 static void TestCountRegularGraphsWithDegree_4_2() {
-  CHECK_EQ(CountRegularGraphsWithDegree(4, 2), 1);
+  CHECK_EQ(CountOrZero(4, 2), 1);
 }
 
 static void TestCountRegularGraphsWithDegree_6_3() {
-  CHECK_EQ(CountRegularGraphsWithDegree(6, 3), 2);
+  CHECK_EQ(CountOrZero(6, 3), 2);
 }
 
 static void TestCountRegularGraphsWithDegree_6_2() {
-  CHECK_EQ(CountRegularGraphsWithDegree(6, 2), 2);
+  CHECK_EQ(CountOrZero(6, 2), 2);
+}
+
+static void TestCountRegularGraphsWithDegree_7_2() {
+  // A 7-cycle, or a 4-cycle and a triangle.
+  CHECK_EQ(CountOrZero(7, 2), 2);
+}
+
+static void TestCountRegularGraphsWithDegree_7_4() {
+  // The complements of the 2-regular graphs.
+  CHECK_EQ(CountOrZero(7, 4), 2);
+}
+
+static void TestCountRegularGraphsWithDegree_LargerOrders() {
+  CHECK_EQ(CountOrZero(10, 3), 21);
+  CHECK_EQ(CountOrZero(12, 3), 94);
+  CHECK_EQ(CountOrZero(10, 4), 60);
+}
+
+static void TestCountRegularGraphsWithDegree_MethodsAgree() {
+  RegularGraphCountingOptions options = {
+      .method = RegularGraphCountingMethod::kCanonicalFormSet};
+  for (auto [order, degree] : {std::pair{8, 3}, {8, 4}, {9, 2}})
+    CHECK_EQ(CountOrZero(order, degree, options), CountOrZero(order, degree));
+}
+
+static void TestCountRegularGraphsWithDegree_Parallel() {
+  SetDefaultConcurrency(4);
+  CHECK_EQ(CountOrZero(12, 3), 94);
+  RegularGraphCountingOptions options = {
+      .method = RegularGraphCountingMethod::kCanonicalFormSet};
+  CHECK_EQ(CountOrZero(8, 3, options), 6);
+  SetDefaultConcurrency(0);
+}
+
+static void TestCountRegularGraphsWithDegree_SpilledForms() {
+  std::string directory = std::filesystem::temp_directory_path();
+  RegularGraphCountingOptions options = {
+      .method = RegularGraphCountingMethod::kCanonicalFormSet,
+      .form_store = {.memory_limit = 1, .spill_directory = directory}};
+  CHECK_EQ(CountOrZero(8, 3, options), 6);
+  CHECK_EQ(CountOrZero(9, 4, options), 16);
+
+  options.form_store.spill_directory = "/nonexistent/directory";
+  CHECK(std::holds_alternative<std::string>(
+      CountRegularGraphsWithDegree(8, 3, options)));
+}
+
+static void TestCountRegularGraphsWithDegree_Checkpoint() {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("counting." + std::to_string(getpid()) + ".checkpoint"))
+                         .string();
+  std::filesystem::remove(path);
+
+  // Stop after three batches, as if preempted.
+  int batches = 0;
+  RegularGraphCountingOptions options = {
+      .checkpoint_path = path,
+      .checkpoint_interval = std::chrono::milliseconds(0),
+      .progress = [&](const RegularGraphCountingProgress &) {
+        return ++batches != 3;
+      }};
+  CHECK(std::holds_alternative<std::string>(
+      CountRegularGraphsWithDegree(12, 3, options)));
+
+  RegularGraphCountingProgress first, last;
+  batches = 0;
+  options.progress = [&](const RegularGraphCountingProgress &progress) {
+    if (batches++ == 0)
+      first = progress;
+    last = progress;
+    return true;
+  };
+  CHECK_EQ(CountOrZero(12, 3, options), 94);
+  CHECK_GT(first.finished_subtrees, 3);
+  CHECK_EQ(last.finished_subtrees, last.total_subtrees);
+  CHECK_EQ(last.count, 94);
+
+  // The finished count is kept, and belongs to one order and degree.
+  batches = 0;
+  CHECK_EQ(CountOrZero(12, 3, options), 94);
+  CHECK_EQ(batches, 0);
+  CHECK(std::holds_alternative<std::string>(
+      CountRegularGraphsWithDegree(10, 3, options)));
+
+  // A checkpoint of a frontier with other graphs, as a build that splits the
+  // search differently would write, is rejected.
+  std::string magic;
+  std::vector<unsigned long> fields(7);
+  {
+    std::ifstream in(path);
+    in >> magic;
+    for (unsigned long &field : fields)
+      in >> field;
+  }
+  fields[4]++;
+  {
+    std::ofstream out(path);
+    out << magic << "\n";
+    for (unsigned long field : fields)
+      out << field << " ";
+  }
+  CHECK(std::holds_alternative<std::string>(
+      CountRegularGraphsWithDegree(12, 3, options)));
+  std::filesystem::remove(path);
 }
 
 #define TEST_LIST(F)                                                           \
   F(TestCountRegularGraphsWithDegree_4_2)                                      \
   F(TestCountRegularGraphsWithDegree_6_3)                                      \
   F(TestCountRegularGraphsWithDegree_6_2)                                      \
+  F(TestCountRegularGraphsWithDegree_7_2)                                      \
+  F(TestCountRegularGraphsWithDegree_7_4)                                      \
+  F(TestCountRegularGraphsWithDegree_LargerOrders)                             \
+  F(TestCountRegularGraphsWithDegree_MethodsAgree)                             \
+  F(TestCountRegularGraphsWithDegree_Parallel)                                 \
+  F(TestCountRegularGraphsWithDegree_SpilledForms)                             \
+  F(TestCountRegularGraphsWithDegree_Checkpoint)                               \
   (void)0;
 
 DEFINE_MAIN(TEST_LIST)
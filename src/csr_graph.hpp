@@ -0,0 +1,105 @@
+#pragma once
+
+#include "graph.hpp"
+#include "graph_view.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace kb {
+namespace detail {
+template <typename IndexTy>
+class CsrEdgeIterator final : public Graph::EdgeIterator {
+public:
+  CsrEdgeIterator(Graph::VertexTy vertex, std::span<const IndexTy> neighbors)
+      : vertex_(vertex), neighbors_(neighbors) {}
+
+  Graph::EdgeTy Get() override { return {vertex_, neighbors_[i_]}; }
+
+  void Next() override { i_++; }
+
+  bool IsAtEnd() override { return i_ == neighbors_.size(); }
+
+private:
+  Graph::OrderTy i_ = 0;
+  Graph::VertexTy vertex_;
+  std::span<const IndexTy> neighbors_;
+};
+
+// Implements the read-only Graph interface over CSR arrays that a subclass
+// owns.  Subclasses publish their arrays with SetView and implement Clone.
+template <typename IndexTy> class CsrGraph : public Graph {
+public:
+  OrderTy GetOrder() override { return view_.GetOrder(); }
+
+  OrderTy GetDegree(VertexTy v) override {
+    assert(v < GetOrder());
+    return view_.GetDegree(v);
+  }
+
+  std::unique_ptr<EdgeIterator> GetEdgesContainingVertex(VertexTy v) override {
+    assert(v < GetOrder());
+    return std::make_unique<CsrEdgeIterator<IndexTy>>(v,
+                                                      view_.GetNeighbors(v));
+  }
+
+  std::span<const VertexTy>
+  GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch) override {
+    assert(v < GetOrder());
+    auto neighbors = view_.GetNeighbors(v);
+    if constexpr (std::is_same_v<IndexTy, VertexTy>) {
+      return neighbors;
+    } else {
+      scratch->assign(neighbors.begin(), neighbors.end());
+      return *scratch;
+    }
+  }
+
+  void AppendUniqueEdges(VertexTy begin, VertexTy end,
+                         std::vector<EdgeTy> *edges) override {
+    assert(end <= GetOrder());
+    for (VertexTy v = begin; v != end; v++) {
+      auto neighbors = view_.GetNeighbors(v);
+      if (sorted_) {
+        // The upper half of a sorted list is a contiguous suffix.
+        auto upper = std::lower_bound(neighbors.begin(), neighbors.end(), v);
+        for (; upper != neighbors.end(); ++upper)
+          edges->push_back({v, *upper});
+      } else {
+        for (IndexTy n : neighbors)
+          if (n >= v)
+            edges->push_back({v, n});
+      }
+    }
+  }
+
+  const CsrGraphView<CompactVertexTy> *GetCompactCsrView() override {
+    if constexpr (std::is_same_v<IndexTy, CompactVertexTy>)
+      return &view_;
+    return nullptr;
+  }
+
+  const CsrGraphView<VertexTy> *GetWideCsrView() override {
+    if constexpr (std::is_same_v<IndexTy, VertexTy>)
+      return &view_;
+    return nullptr;
+  }
+
+protected:
+  // `sorted` states whether every neighbor list is in ascending order.
+  void SetView(CsrGraphView<IndexTy> view, bool sorted) {
+    view_ = view;
+    sorted_ = sorted;
+  }
+  const CsrGraphView<IndexTy> &GetView() const { return view_; }
+
+private:
+  CsrGraphView<IndexTy> view_;
+  bool sorted_ = false;
+};
+} // namespace detail
+} // namespace kb
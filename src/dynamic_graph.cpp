@@ -0,0 +1,153 @@
+#include "dynamic_graph.hpp"
+
+#include "csr_graph.hpp"
+
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace kb {
+namespace {
+struct EdgeHash {
+  size_t operator()(const Graph::EdgeTy &e) const {
+    return std::hash<Graph::VertexTy>()(e.first * 0x9e3779b97f4a7c15ul ^
+                                        e.second);
+  }
+};
+
+// Every vertex owns a growable adjacency list, and `positions` maps each
+// directed edge (a, b) to the index of `b` in the list of `a`, so that edges
+// can be found and removed without scanning.
+struct DynamicGraphState {
+  std::vector<std::vector<Graph::VertexTy>> adjacency;
+  std::unordered_map<Graph::EdgeTy, size_t, EdgeHash> positions;
+};
+
+// The state is shared between clones and copied by the first clone that
+// modifies it.
+class DynamicGraphImpl final : public DynamicGraph {
+public:
+  explicit DynamicGraphImpl(OrderTy order)
+      : state_(std::make_shared<DynamicGraphState>()) {
+    state_->adjacency.resize(order);
+  }
+
+  explicit DynamicGraphImpl(std::shared_ptr<DynamicGraphState> state)
+      : state_(std::move(state)) {}
+
+  bool AddEdge(VertexTy a, VertexTy b) override {
+    assert(a < GetOrder());
+    assert(b < GetOrder());
+    if (HasEdge(a, b))
+      return false;
+    DynamicGraphState *state = GetMutableState();
+    AddDirectedEdge(state, a, b);
+    if (a != b)
+      AddDirectedEdge(state, b, a);
+    return true;
+  }
+
+  bool RemoveEdge(VertexTy a, VertexTy b) override {
+    assert(a < GetOrder());
+    assert(b < GetOrder());
+    if (!HasEdge(a, b))
+      return false;
+    DynamicGraphState *state = GetMutableState();
+    RemoveDirectedEdge(state, a, b);
+    if (a != b)
+      RemoveDirectedEdge(state, b, a);
+    return true;
+  }
+
+  bool HasEdge(VertexTy a, VertexTy b) override {
+    return state_->positions.contains({a, b});
+  }
+
+  std::unique_ptr<Graph> Snapshot() override {
+    const auto &adjacency = state_->adjacency;
+    std::vector<size_t> offsets;
+    offsets.reserve(adjacency.size() + 1);
+    offsets.push_back(0);
+    for (const auto &neighbors : adjacency)
+      offsets.push_back(offsets.back() + neighbors.size());
+
+    std::vector<VertexTy> all_neighbors;
+    all_neighbors.reserve(offsets.back());
+    for (const auto &neighbors : adjacency)
+      all_neighbors.insert(all_neighbors.end(), neighbors.begin(),
+                           neighbors.end());
+
+    return CreateConcreteGraphFromAdjacency(std::move(offsets),
+                                            std::move(all_neighbors));
+  }
+
+  std::unique_ptr<EdgeIterator> GetEdgesContainingVertex(VertexTy v) override {
+    assert(v < GetOrder());
+    return std::make_unique<detail::CsrEdgeIterator<VertexTy>>(
+        v, state_->adjacency[v]);
+  }
+
+  std::span<const VertexTy> GetNeighbors(VertexTy v,
+                                         std::vector<VertexTy> *) override {
+    assert(v < GetOrder());
+    return state_->adjacency[v];
+  }
+
+  OrderTy GetDegree(VertexTy v) override {
+    assert(v < GetOrder());
+    return state_->adjacency[v].size();
+  }
+
+  OrderTy GetOrder() override { return state_->adjacency.size(); }
+
+  std::unique_ptr<Graph> Clone() override {
+    return std::make_unique<DynamicGraphImpl>(state_);
+  }
+
+private:
+  DynamicGraphState *GetMutableState() {
+    if (state_.use_count() > 1)
+      state_ = std::make_shared<DynamicGraphState>(*state_);
+    return state_.get();
+  }
+
+  static void AddDirectedEdge(DynamicGraphState *state, VertexTy a,
+                              VertexTy b) {
+    state->positions[{a, b}] = state->adjacency[a].size();
+    state->adjacency[a].push_back(b);
+  }
+
+  static void RemoveDirectedEdge(DynamicGraphState *state, VertexTy a,
+                                 VertexTy b) {
+    auto it = state->positions.find({a, b});
+    assert(it != state->positions.end());
+
+    std::vector<VertexTy> &neighbors = state->adjacency[a];
+    size_t position = it->second;
+    state->positions.erase(it);
+    if (position != neighbors.size() - 1) {
+      neighbors[position] = neighbors.back();
+      state->positions[{a, neighbors[position]}] = position;
+    }
+    neighbors.pop_back();
+  }
+
+  std::shared_ptr<DynamicGraphState> state_;
+};
+} // namespace
+
+std::unique_ptr<DynamicGraph> CreateDynamicGraph(Graph::OrderTy order) {
+  return std::make_unique<DynamicGraphImpl>(order);
+}
+
+std::unique_ptr<DynamicGraph> CreateDynamicGraph(Graph *g) {
+  auto dynamic_graph = std::make_unique<DynamicGraphImpl>(g->GetOrder());
+  std::vector<Graph::VertexTy> scratch;
+  for (Graph::VertexTy v = 0, e = g->GetOrder(); v != e; v++)
+    for (Graph::VertexTy n : g->GetNeighbors(v, &scratch))
+      if (n >= v)
+        dynamic_graph->AddEdge(v, n);
+  return dynamic_graph;
+}
+} // namespace kb
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <memory>
+
+namespace kb {
+// A graph whose edges can be added and removed after construction.  Adjacency
+// lists are kept in insertion order, with removals filling the hole with the
+// last neighbor, so they are not sorted.  Clones share storage until one of
+// them is modified.
+class DynamicGraph : public Graph {
+public:
+  // Adds the undirected edge (a, b).  Returns false if it was already present.
+  // Amortized O(1).
+  virtual bool AddEdge(VertexTy a, VertexTy b) = 0;
+
+  // Removes the undirected edge (a, b).  Returns false if it was not present.
+  // O(1).
+  virtual bool RemoveEdge(VertexTy a, VertexTy b) = 0;
+
+  // O(1).
+  virtual bool HasEdge(VertexTy a, VertexTy b) = 0;
+
+  // Returns an immutable CSR copy of the current graph, for read heavy phases
+  // such as running the analysis kernels.
+  virtual std::unique_ptr<Graph> Snapshot() = 0;
+};
+
+// Creates a dynamic graph with `order` vertices and no edges.
+std::unique_ptr<DynamicGraph> CreateDynamicGraph(Graph::OrderTy order);
+
+// Creates a dynamic graph with the same vertices and edges as `g`.
+std::unique_ptr<DynamicGraph> CreateDynamicGraph(Graph *g);
+} // namespace kb
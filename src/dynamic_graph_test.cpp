@@ -0,0 +1,102 @@
+#include "dynamic_graph.hpp"
+
+#include "graph_zoo.hpp"
+#include "test.hpp"
+
+#include <vector>
+
+using namespace kb;
+
+static void TestAddAndRemoveEdges() {
+  auto graph = CreateDynamicGraph(5);
+  CHECK(graph->AddEdge(0, 1));
+  CHECK(graph->AddEdge(2, 1));
+  CHECK(graph->AddEdge(3, 3));
+  CHECK(graph->AddEdge(0, 4));
+  CHECK(!graph->AddEdge(1, 0));
+  CHECK(!graph->AddEdge(3, 3));
+
+  CHECK(graph->HasEdge(1, 0));
+  CHECK(graph->HasEdge(1, 2));
+  CHECK(!graph->HasEdge(0, 2));
+  CHECK_EQ(graph->GetDegree(1), 2);
+  CHECK_EQ(graph->GetDegree(3), 1);
+  CHECK(!CheckConsistency(graph.get()).has_value());
+
+  CHECK(graph->RemoveEdge(1, 0));
+  CHECK(!graph->RemoveEdge(0, 1));
+  CHECK(graph->RemoveEdge(3, 3));
+  CHECK(!graph->HasEdge(0, 1));
+  CHECK(graph->HasEdge(0, 4));
+  CHECK_EQ(graph->GetDegree(0), 1);
+  CHECK(!CheckConsistency(graph.get()).has_value());
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 4}, {1, 2}};
+  CHECK_EDGES_EQ(expected_edges, graph);
+}
+
+static void TestRemoveFromMiddleOfAdjacency() {
+  auto graph = CreateDynamicGraph(6);
+  for (Graph::VertexTy v = 1; v < 6; v++)
+    graph->AddEdge(0, v);
+
+  CHECK(graph->RemoveEdge(0, 2));
+  CHECK(graph->RemoveEdge(0, 1));
+  CHECK(graph->HasEdge(0, 5));
+  CHECK(graph->RemoveEdge(0, 5));
+  CHECK(!CheckConsistency(graph.get()).has_value());
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 3}, {0, 4}};
+  CHECK_EDGES_EQ(expected_edges, graph);
+}
+
+static void TestCreateFromGraph() {
+  auto ring = CreateRingGraph(6);
+  auto graph = CreateDynamicGraph(ring.get());
+  CHECK_EQ(graph->GetOrder(), 6);
+  CHECK(graph->HasEdge(5, 0));
+
+  // Perturbing the copy leaves the original alone.
+  CHECK(graph->RemoveEdge(5, 0));
+  CHECK(graph->AddEdge(0, 3));
+  std::vector<Graph::EdgeTy> ring_edges = {{0, 1}, {1, 2}, {2, 3},
+                                           {3, 4}, {4, 5}, {0, 5}};
+  CHECK_EDGES_EQ(ring_edges, ring);
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 1}, {1, 2}, {2, 3},
+                                               {3, 4}, {4, 5}, {0, 3}};
+  CHECK_EDGES_EQ(expected_edges, graph);
+}
+
+static void TestSnapshotAndClone() {
+  auto graph = CreateDynamicGraph(4);
+  graph->AddEdge(0, 1);
+  graph->AddEdge(3, 1);
+  graph->AddEdge(2, 2);
+
+  std::unique_ptr<Graph> snapshot = graph->Snapshot();
+  std::unique_ptr<Graph> clone = graph->Clone();
+  std::vector<Graph::VertexTy> scratch;
+  CHECK_EQ(clone->GetNeighbors(1, &scratch).data(),
+           graph->GetNeighbors(1, &scratch).data());
+
+  // Modifying the original copies its storage, leaving the clone alone.
+  graph->RemoveEdge(0, 1);
+  CHECK(clone->GetNeighbors(1, &scratch).data() !=
+        graph->GetNeighbors(1, &scratch).data());
+
+  CHECK(snapshot->GetCompactCsrView() != nullptr);
+  CHECK(!CheckConsistency(snapshot.get()).has_value());
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 1}, {1, 3}, {2, 2}};
+  CHECK_EDGES_EQ(expected_edges, snapshot);
+  CHECK_EDGES_EQ(expected_edges, clone);
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestAddAndRemoveEdges)                                                     \
+  F(TestRemoveFromMiddleOfAdjacency)                                           \
+  F(TestCreateFromGraph)                                                       \
+  F(TestSnapshotAndClone)                                                      \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
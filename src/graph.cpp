@@ -1,9 +1,14 @@
 #include "graph.hpp"
 
-#include "logging.hpp"
+#include "csr_graph.hpp"
+#include "graph_view.hpp"
+#include "parallel.hpp"
 
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,57 +33,47 @@ private:
   const Graph::OrderTy order_;
 };
 
+// Vertices whose edges are read with one AppendUniqueEdges call when
+// enumerating edges in chunks.
+constexpr Graph::OrderTy kEdgeChunkVertices = 256;
+
+// Reads the unique edges of a graph through AppendUniqueEdges, a batch of
+// vertices at a time.
 class FiniteGraphEdgeIterator final : public Graph::EdgeIterator {
 public:
-  FiniteGraphEdgeIterator(Graph *g)
-      : graph_(g), vertex_iterator_(g->GetVertices()),
-        current_edge_iterator_(
-            graph_->GetEdgesContainingVertex(vertex_iterator_->Get())) {
-    AdvanceToNextValidEdge();
+  FiniteGraphEdgeIterator(Graph *g) : graph_(g), order_(g->GetOrder()) {
+    Refill();
   }
 
   Graph::EdgeTy Get() override {
     assert(!IsAtEnd());
-    return current_edge_iterator_->Get();
+    return buffer_[position_];
   }
 
   void Next() override {
     assert(!IsAtEnd());
-
-    do {
-      current_edge_iterator_->Next();
-      AdvanceToNextValidEdge();
-    } while (!vertex_iterator_->IsAtEnd() && ShouldSkipCurrentEdge());
+    if (++position_ == buffer_.size())
+      Refill();
   }
 
-  bool IsAtEnd() override { return current_edge_iterator_ == nullptr; }
+  bool IsAtEnd() override { return position_ == buffer_.size(); }
 
 private:
-  bool ShouldSkipCurrentEdge() {
-    auto e = current_edge_iterator_->Get();
-    if (e.first != vertex_iterator_->Get())
-      std::swap(e.first, e.second);
-
-    assert(e.first == vertex_iterator_->Get());
-    return e.second < e.first;
-  }
-
-  void AdvanceToNextValidEdge() {
-    while (current_edge_iterator_->IsAtEnd() && !vertex_iterator_->IsAtEnd()) {
-      vertex_iterator_->Next();
-
-      LOG << "Updating current_edge_iterator_\n";
-      current_edge_iterator_ =
-          graph_->GetEdgesContainingVertex(vertex_iterator_->Get());
+  void Refill() {
+    buffer_.clear();
+    position_ = 0;
+    while (buffer_.empty() && next_vertex_ != order_) {
+      Graph::VertexTy end = std::min(next_vertex_ + kEdgeChunkVertices, order_);
+      graph_->AppendUniqueEdges(next_vertex_, end, &buffer_);
+      next_vertex_ = end;
     }
-
-    if (vertex_iterator_->IsAtEnd())
-      current_edge_iterator_ = nullptr;
   }
 
   Graph *graph_;
-  std::unique_ptr<Graph::VertexIterator> vertex_iterator_;
-  std::unique_ptr<Graph::EdgeIterator> current_edge_iterator_;
+  const Graph::OrderTy order_;
+  Graph::VertexTy next_vertex_ = 0;
+  std::vector<Graph::EdgeTy> buffer_;
+  size_t position_ = 0;
 };
 } // namespace
 
@@ -90,63 +85,170 @@ std::unique_ptr<Graph::EdgeIterator> Graph::GetEdges() {
   return std::make_unique<FiniteGraphEdgeIterator>(this);
 }
 
-namespace {
-class ConcreteGraph final : public Graph {
-public:
-  ConcreteGraph(Graph::OrderTy order, std::span<Graph::EdgeTy> edges)
-      : order_(order) {
-    std::set<Graph::EdgeTy> double_edge_set;
-    for (Graph::EdgeTy e : edges) {
-      assert(e.first < order_);
-      assert(e.second < order_);
+Graph::OrderTy Graph::GetDegree(VertexTy v) {
+  std::vector<VertexTy> scratch;
+  return GetNeighbors(v, &scratch).size();
+}
 
-      double_edge_set.insert(e);
-      std::swap(e.first, e.second);
-      double_edge_set.insert(e);
-    }
+const CsrGraphView<CompactVertexTy> *Graph::GetCompactCsrView() {
+  return nullptr;
+}
 
-    for (Graph::EdgeTy e : double_edge_set)
-      edges_.push_back(e);
-  }
+const CsrGraphView<Graph::VertexTy> *Graph::GetWideCsrView() { return nullptr; }
 
-  class EdgeIterator : public Graph::EdgeIterator {
-  public:
-    EdgeIterator(std::span<Graph::EdgeTy> edges) : edges_(edges) {}
+const BitMatrixView *Graph::GetBitMatrixView() { return nullptr; }
 
-    EdgeTy Get() override { return edges_[i_]; }
+void Graph::AppendUniqueEdges(VertexTy begin, VertexTy end,
+                              std::vector<EdgeTy> *edges) {
+  std::vector<VertexTy> scratch;
+  for (VertexTy v = begin; v != end; v++)
+    for (VertexTy n : GetNeighbors(v, &scratch))
+      if (n >= v)
+        edges->push_back({v, n});
+}
 
-    void Next() override { i_++; }
+std::span<const Graph::VertexTy>
+Graph::GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch) {
+  scratch->clear();
+  for (EdgeTy e : Iterate(GetEdgesContainingVertex(v)))
+    scratch->push_back(e.first == v ? e.second : e.first);
+  return *scratch;
+}
 
-    bool IsAtEnd() override { return i_ == edges_.size(); }
+namespace {
+// Below this many edges per task graph construction is not worth spreading
+// over multiple threads.
+constexpr size_t kConstructionGrain = 1 << 16;
+
+// Sorts every adjacency list in place.  Unless `assume_unique` is set this also
+// removes repeated neighbors, compacting `*neighbors` and rewriting `*offsets`
+// to match.
+template <typename IndexTy>
+void SortAndDeduplicateAdjacency(std::vector<size_t> *offsets,
+                                 std::vector<IndexTy> *neighbors,
+                                 bool assume_unique) {
+  Graph::OrderTy order = offsets->size() - 1;
+  unsigned tasks = GetTaskCount(neighbors->size(), kConstructionGrain);
+
+  std::vector<size_t> unique_degrees(assume_unique ? 0 : order);
+  ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t v = begin; v != end; v++) {
+      auto first = neighbors->begin() + (*offsets)[v];
+      auto last = neighbors->begin() + (*offsets)[v + 1];
+      std::sort(first, last);
+      if (!assume_unique)
+        unique_degrees[v] = std::unique(first, last) - first;
+    }
+  });
+
+  if (assume_unique)
+    return;
+
+  std::vector<size_t> unique_offsets(order + 1, 0);
+  for (Graph::OrderTy v = 0; v < order; v++)
+    unique_offsets[v + 1] = unique_offsets[v] + unique_degrees[v];
+  if (unique_offsets.back() == neighbors->size())
+    return;
+
+  std::vector<IndexTy> unique_neighbors(unique_offsets.back());
+  ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t v = begin; v != end; v++)
+      std::copy_n(neighbors->begin() + (*offsets)[v], unique_degrees[v],
+                  unique_neighbors.begin() + unique_offsets[v]);
+  });
+
+  *offsets = std::move(unique_offsets);
+  *neighbors = std::move(unique_neighbors);
+}
+
+// Builds a symmetric CSR adjacency from an undirected edge list by bucketing
+// both directions of every edge by source vertex and then sorting each
+// (short) bucket, instead of sorting the whole edge list.
+template <typename IndexTy>
+void BuildCsr(Graph::OrderTy order, std::span<Graph::EdgeTy> edges,
+              bool assume_unique, std::vector<size_t> *offsets,
+              std::vector<IndexTy> *neighbors) {
+  unsigned tasks = GetTaskCount(edges.size(), kConstructionGrain);
+  auto increment = [&](size_t &counter) -> size_t {
+    if (tasks == 1)
+      return counter++;
+    return std::atomic_ref<size_t>(counter).fetch_add(
+        1, std::memory_order_relaxed);
+  };
 
-  private:
-    Graph::OrderTy i_ = 0;
-    std::span<Graph::EdgeTy> edges_;
+  // First count the degree of every vertex into offsets[v + 1] ...
+  offsets->assign(order + 1, 0);
+  ParallelFor(edges.size(), tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i != end; i++) {
+      auto [a, b] = edges[i];
+      assert(a < order);
+      assert(b < order);
+
+      increment((*offsets)[a + 1]);
+      if (a != b)
+        increment((*offsets)[b + 1]);
+    }
+  });
+
+  for (Graph::OrderTy v = 0; v < order; v++)
+    (*offsets)[v + 1] += (*offsets)[v];
+
+  // ... and then scatter every edge into the buckets of both its endpoints.
+  neighbors->resize(offsets->back());
+  std::vector<size_t> cursors(offsets->begin(), offsets->end() - 1);
+  ParallelFor(edges.size(), tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i != end; i++) {
+      auto [a, b] = edges[i];
+      (*neighbors)[increment(cursors[a])] = b;
+      if (a != b)
+        (*neighbors)[increment(cursors[b])] = a;
+    }
+  });
+
+  SortAndDeduplicateAdjacency(offsets, neighbors, assume_unique);
+}
+
+// Stores the adjacency in compressed sparse row form, with neighbor lists
+// sorted in ascending order and vertex indices stored as `IndexTy`.  The
+// arrays are immutable and shared between clones.
+template <typename IndexTy>
+class ConcreteGraph final : public detail::CsrGraph<IndexTy> {
+public:
+  struct Storage {
+    std::vector<size_t> offsets;
+    std::vector<IndexTy> neighbors;
   };
 
-  OrderTy GetOrder() override { return order_; }
+  ConcreteGraph(Graph::OrderTy order, std::span<Graph::EdgeTy> edges,
+                bool assume_unique) {
+    auto storage = std::make_shared<Storage>();
+    BuildCsr(order, edges, assume_unique, &storage->offsets,
+             &storage->neighbors);
+    SetStorage(std::move(storage));
+  }
+
+  ConcreteGraph(std::vector<size_t> offsets, std::vector<IndexTy> neighbors) {
+    SetStorage(std::make_shared<const Storage>(
+        Storage{std::move(offsets), std::move(neighbors)}));
+  }
 
-  std::unique_ptr<Graph::EdgeIterator>
-  GetEdgesContainingVertex(Graph::VertexTy v) override {
-    auto it_begin =
-        std::upper_bound(edges_.begin(), edges_.end(), 0,
-                         [&](int, Graph::EdgeTy e) { return e.first >= v; });
-    auto it_end =
-        std::upper_bound(edges_.begin(), edges_.end(), 0,
-                         [&](int, Graph::EdgeTy e) { return e.first > v; });
-    size_t offset = it_begin - edges_.begin();
-    size_t size = it_end - it_begin;
-    return std::make_unique<EdgeIterator>(
-        std::span<Graph::EdgeTy>(edges_).subspan(offset, size));
+  explicit ConcreteGraph(std::shared_ptr<const Storage> storage) {
+    SetStorage(std::move(storage));
   }
 
   std::unique_ptr<Graph> Clone() override {
-    return std::make_unique<ConcreteGraph>(order_, edges_);
+    return std::make_unique<ConcreteGraph>(storage_);
   }
 
 private:
-  Graph::OrderTy order_;
-  std::vector<Graph::EdgeTy> edges_;
+  void SetStorage(std::shared_ptr<const Storage> storage) {
+    storage_ = std::move(storage);
+    this->SetView(
+        CsrGraphView<IndexTy>(storage_->offsets, storage_->neighbors),
+        /*sorted=*/true);
+  }
+
+  std::shared_ptr<const Storage> storage_;
 };
 } // namespace
 
@@ -155,50 +257,302 @@ Graph::~Graph() {}
 Graph::VertexIterator::~VertexIterator() {}
 Graph::EdgeIterator::~EdgeIterator() {}
 
-std::unique_ptr<Graph> CreateConcreteGraph(Graph::OrderTy order,
-                                           std::span<Graph::EdgeTy> edges) {
-  return std::make_unique<ConcreteGraph>(order, edges);
+std::vector<Graph::VertexTy> PartitionVertices(Graph *g,
+                                               unsigned num_ranges) {
+  num_ranges = std::max(num_ranges, 1u);
+  Graph::OrderTy order = g->GetOrder();
+
+  // Every vertex costs one unit besides its degree, so that long runs of
+  // isolated vertices are split as well.
+  size_t total_cost = 0;
+  for (Graph::VertexTy v = 0; v != order; v++)
+    total_cost += g->GetDegree(v) + 1;
+
+  std::vector<Graph::VertexTy> boundaries = {0};
+  size_t cost = 0;
+  Graph::VertexTy v = 0;
+  for (unsigned range = 1; range < num_ranges; range++) {
+    size_t target = total_cost * range / num_ranges;
+    while (v != order && cost + g->GetDegree(v) + 1 <= target)
+      cost += g->GetDegree(v++) + 1;
+    boundaries.push_back(v);
+  }
+  boundaries.push_back(order);
+  return boundaries;
 }
 
-std::optional<std::string> CheckConsistency(Graph *g) {
-  std::set<Graph::EdgeTy> double_edges;
-  for (Graph::EdgeTy e : Iterate(g->GetEdges())) {
-    double_edges.insert(e);
-    std::swap(e.first, e.second);
-    double_edges.insert(e);
+void ForEachEdgeChunk(
+    Graph *g, const std::function<void(std::span<const Graph::EdgeTy>)> &fn,
+    size_t chunk_size) {
+  std::vector<Graph::EdgeTy> chunk;
+  for (Graph::VertexTy v = 0, order = g->GetOrder(); v != order;) {
+    Graph::VertexTy end = std::min(v + kEdgeChunkVertices, order);
+    g->AppendUniqueEdges(v, end, &chunk);
+    v = end;
+    if (chunk.size() >= chunk_size) {
+      fn(chunk);
+      chunk.clear();
+    }
   }
+  if (!chunk.empty())
+    fn(chunk);
+}
 
-  bool ok = true;
-  std::stringstream ss;
-  for (Graph::VertexTy v : Iterate(g->GetVertices())) {
-    for (Graph::EdgeTy e : Iterate(g->GetEdgesContainingVertex(v))) {
-      auto it = double_edges.find(e);
-      if (it == double_edges.end()) {
-        ok = false;
-        ss << "Edge (" << e.first << ", " << e.second
-           << ") found in vertex adjacency list for " << v
-           << " but not in edge list\n";
-      } else {
-        double_edges.erase(it);
+std::unique_ptr<Graph> CreateConcreteGraph(Graph::OrderTy order,
+                                           std::span<Graph::EdgeTy> edges,
+                                           bool assume_unique) {
+  if (FitsCompactVertexTy(order))
+    return std::make_unique<ConcreteGraph<CompactVertexTy>>(order, edges,
+                                                            assume_unique);
+  return std::make_unique<ConcreteGraph<Graph::VertexTy>>(order, edges,
+                                                          assume_unique);
+}
+
+std::unique_ptr<Graph>
+CreateConcreteGraphFromAdjacency(std::vector<size_t> offsets,
+                                 std::vector<CompactVertexTy> neighbors) {
+  assert(!offsets.empty());
+  SortAndDeduplicateAdjacency(&offsets, &neighbors, /*assume_unique=*/false);
+  return std::make_unique<ConcreteGraph<CompactVertexTy>>(std::move(offsets),
+                                                          std::move(neighbors));
+}
+
+std::unique_ptr<Graph>
+CreateConcreteGraphFromAdjacency(std::vector<size_t> offsets,
+                                 std::vector<Graph::VertexTy> neighbors) {
+  assert(!offsets.empty());
+  if (FitsCompactVertexTy(offsets.size() - 1))
+    return CreateConcreteGraphFromAdjacency(
+        std::move(offsets), std::vector<CompactVertexTy>(neighbors.begin(),
+                                                         neighbors.end()));
+
+  SortAndDeduplicateAdjacency(&offsets, &neighbors, /*assume_unique=*/false);
+  return std::make_unique<ConcreteGraph<Graph::VertexTy>>(std::move(offsets),
+                                                          std::move(neighbors));
+}
+
+namespace {
+// Sampled vertices are checked against all their neighbors, so far fewer of
+// them make a task worthwhile.
+constexpr size_t kSampledCheckGrain = 1 << 10;
+
+// Edges in the edge list, keyed by their first vertex in CSR form.  Edges
+// whose first vertex is out of range are kept aside in `strays`.
+struct EdgeListIndex {
+  std::vector<size_t> offsets;
+  std::vector<Graph::VertexTy> neighbors;
+  std::vector<Graph::EdgeTy> strays;
+};
+
+EdgeListIndex IndexEdgeList(Graph *g) {
+  Graph::OrderTy order = g->GetOrder();
+  unsigned ranges = GetTaskCount(order, kConstructionGrain / 16);
+  std::vector<Graph::VertexTy> boundaries = PartitionVertices(g, ranges);
+  std::vector<std::vector<Graph::EdgeTy>> range_edges(ranges);
+  ParallelFor(ranges, ranges, [&](unsigned, size_t begin, size_t end) {
+    for (size_t range = begin; range != end; range++)
+      g->AppendUniqueEdges(boundaries[range], boundaries[range + 1],
+                           &range_edges[range]);
+  });
+
+  std::vector<Graph::EdgeTy> directed_edges;
+  EdgeListIndex index;
+  for (const auto &edges : range_edges) {
+    for (Graph::EdgeTy e : edges) {
+      for (Graph::EdgeTy directed : {e, Graph::EdgeTy{e.second, e.first}}) {
+        if (directed.first < order)
+          directed_edges.push_back(directed);
+        else
+          index.strays.push_back(directed);
+        if (e.first == e.second)
+          break;
       }
     }
   }
 
-  if (!double_edges.empty()) {
-    ok = false;
-    ss << "The following edges were found in the edge list but not in any "
-          "vertex "
-          "adjacency list: ";
-    for (auto e : double_edges) {
-      ss << "(" << e.first << ", " << e.second << ") ";
+  unsigned tasks = GetTaskCount(directed_edges.size(), kConstructionGrain);
+  auto increment = [&](size_t &counter) -> size_t {
+    if (tasks == 1)
+      return counter++;
+    return std::atomic_ref<size_t>(counter).fetch_add(
+        1, std::memory_order_relaxed);
+  };
+
+  size_t edge_count = directed_edges.size();
+  index.offsets.assign(order + 1, 0);
+  ParallelFor(edge_count, tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i != end; i++)
+      increment(index.offsets[directed_edges[i].first + 1]);
+  });
+  for (Graph::OrderTy v = 0; v < order; v++)
+    index.offsets[v + 1] += index.offsets[v];
+
+  index.neighbors.resize(index.offsets.back());
+  std::vector<size_t> cursors(index.offsets.begin(), index.offsets.end() - 1);
+  ParallelFor(edge_count, tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i != end; i++) {
+      auto [a, b] = directed_edges[i];
+      index.neighbors[increment(cursors[a])] = b;
+    }
+  });
+
+  // The edge list may repeat edges; like the adjacency lists they only count
+  // once.
+  SortAndDeduplicateAdjacency(&index.offsets, &index.neighbors,
+                              /*assume_unique=*/false);
+  std::sort(index.strays.begin(), index.strays.end());
+  index.strays.erase(std::unique(index.strays.begin(), index.strays.end()),
+                     index.strays.end());
+  return index;
+}
+
+void ReportMissingEdges(const std::vector<Graph::EdgeTy> &missing,
+                        std::stringstream *ss) {
+  *ss << "The following edges were found in the edge list but not in any "
+         "vertex "
+         "adjacency list: ";
+  for (auto e : missing) {
+    *ss << "(" << e.first << ", " << e.second << ") ";
+  }
+  *ss << "\n";
+}
+
+// Compares the adjacency list of `v` against the edges of the edge list that
+// start at `v`.  Adjacency entries repeated more often than in the edge list
+// are reported once per extra occurrence.
+void CompareAdjacency(Graph::VertexTy v,
+                      std::span<const Graph::VertexTy> actual,
+                      std::span<const Graph::VertexTy> expected,
+                      std::stringstream *unexpected,
+                      std::vector<Graph::EdgeTy> *missing,
+                      std::vector<Graph::VertexTy> *scratch) {
+  scratch->clear();
+  std::set_difference(actual.begin(), actual.end(), expected.begin(),
+                      expected.end(), std::back_inserter(*scratch));
+  for (Graph::VertexTy n : *scratch)
+    *unexpected << "Edge (" << v << ", " << n
+                << ") found in vertex adjacency list for " << v
+                << " but not in edge list\n";
+
+  scratch->clear();
+  std::set_difference(expected.begin(), expected.end(), actual.begin(),
+                      actual.end(), std::back_inserter(*scratch));
+  for (Graph::VertexTy n : *scratch)
+    missing->push_back({v, n});
+}
+
+// Compares the indexed edge list against every adjacency list.  Each task
+// handles a contiguous range of vertices, so the reports come out in vertex
+// order, as if produced by a single pass.
+std::optional<std::string> CheckAllAdjacency(Graph *g) {
+  EdgeListIndex index = IndexEdgeList(g);
+
+  Graph::OrderTy order = g->GetOrder();
+  unsigned tasks = GetTaskCount(
+      std::max<size_t>(index.neighbors.size(), order), kConstructionGrain);
+  std::vector<std::stringstream> unexpected(tasks);
+  std::vector<std::vector<Graph::EdgeTy>> missing(tasks);
+  ParallelFor(order, tasks, [&](unsigned task, size_t begin, size_t end) {
+    std::vector<Graph::VertexTy> scratch;
+    std::vector<Graph::VertexTy> sorted;
+    std::vector<Graph::VertexTy> difference;
+    for (Graph::VertexTy v = begin; v != end; v++) {
+      auto actual = g->GetNeighbors(v, &scratch);
+      if (!std::is_sorted(actual.begin(), actual.end())) {
+        sorted.assign(actual.begin(), actual.end());
+        std::sort(sorted.begin(), sorted.end());
+        actual = sorted;
+      }
+      std::span<const Graph::VertexTy> expected(
+          index.neighbors.data() + index.offsets[v],
+          index.offsets[v + 1] - index.offsets[v]);
+      CompareAdjacency(v, actual, expected, &unexpected[task], &missing[task],
+                       &difference);
     }
-    ss << "\n";
+  });
+
+  std::stringstream ss;
+  std::vector<Graph::EdgeTy> all_missing;
+  for (unsigned task = 0; task < tasks; task++) {
+    ss << unexpected[task].rdbuf();
+    all_missing.insert(all_missing.end(), missing[task].begin(),
+                       missing[task].end());
   }
+  all_missing.insert(all_missing.end(), index.strays.begin(),
+                     index.strays.end());
+  if (!all_missing.empty())
+    ReportMissingEdges(all_missing, &ss);
+
+  std::string report = ss.str();
+  if (report.empty())
+    return std::nullopt;
+  return report;
+}
 
-  if (ok)
+// Checks that the adjacency lists of the sampled vertices are in range,
+// agree with GetDegree, and are mirrored in the adjacency lists of their
+// neighbors.
+std::optional<std::string>
+CheckSampledAdjacency(Graph *g, std::span<const Graph::VertexTy> sample) {
+  Graph::OrderTy order = g->GetOrder();
+  size_t sample_size = sample.size();
+  unsigned tasks = GetTaskCount(sample_size, kSampledCheckGrain);
+  std::vector<std::stringstream> reports(tasks);
+  ParallelFor(sample_size, tasks, [&](unsigned task, size_t begin, size_t end) {
+    std::vector<Graph::VertexTy> scratch;
+    std::vector<Graph::VertexTy> mirror_scratch;
+    std::stringstream &ss = reports[task];
+    for (size_t i = begin; i != end; i++) {
+      Graph::VertexTy v = sample[i];
+      auto neighbors = g->GetNeighbors(v, &scratch);
+      if (g->GetDegree(v) != neighbors.size())
+        ss << "Vertex " << v << " has degree " << g->GetDegree(v) << " but "
+           << neighbors.size() << " neighbors\n";
+
+      for (Graph::VertexTy n : neighbors) {
+        if (n >= order) {
+          ss << "Edge (" << v << ", " << n
+             << ") found in vertex adjacency list for " << v << " but " << n
+             << " is not a vertex\n";
+          continue;
+        }
+        auto mirror = g->GetNeighbors(n, &mirror_scratch);
+        if (std::find(mirror.begin(), mirror.end(), v) == mirror.end())
+          ss << "Edge (" << v << ", " << n
+             << ") found in vertex adjacency list for " << v
+             << " but not in vertex adjacency list for " << n << "\n";
+      }
+    }
+  });
+
+  std::stringstream ss;
+  for (std::stringstream &report : reports)
+    ss << report.rdbuf();
+  std::string report = ss.str();
+  if (report.empty())
     return std::nullopt;
-  else
-    return ss.str();
+  return report;
+}
+} // namespace
+
+std::optional<std::string>
+CheckConsistency(Graph *g, const ConsistencyCheckOptions &options) {
+  if (!options.sample_size)
+    return CheckAllAdjacency(g);
+
+  Graph::OrderTy order = g->GetOrder();
+  std::vector<Graph::VertexTy> sample;
+  if (*options.sample_size >= order) {
+    sample.resize(order);
+    std::iota(sample.begin(), sample.end(), 0);
+  } else {
+    std::mt19937_64 engine(options.seed);
+    std::uniform_int_distribution<Graph::VertexTy> distribution(0, order - 1);
+    sample.resize(*options.sample_size);
+    for (Graph::VertexTy &v : sample)
+      v = distribution(engine);
+  }
+  return CheckSampledAdjacency(g, sample);
 }
 
 std::ostream &operator<<(std::ostream &os, const Graph::EdgeTy &e) {
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
+#include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 namespace kb {
+class BitMatrixView;
+template <typename IndexTy> class CsrGraphView;
+
+// The vertex index type graph storage uses when the order allows it.
+using CompactVertexTy = std::uint32_t;
+
 class Graph {
 public:
   using VertexTy = unsigned long;
@@ -35,11 +46,44 @@ public:
   virtual std::unique_ptr<EdgeIterator>
   GetEdgesContainingVertex(VertexTy v) = 0;
 
+  // Returns the neighbors of `v`, in the same order as
+  // GetEdgesContainingVertex.  Representations that store their adjacency
+  // contiguously as VertexTy return a view into that storage and leave
+  // `scratch` alone; the others fill `scratch` and return a view into it.  The
+  // result stays valid until `scratch` is next modified.
+  virtual std::span<const VertexTy>
+  GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch);
+
+  // Returns the number of neighbors of `v`, counting a self loop once.
+  // Representations override this to answer without walking the adjacency.
+  virtual OrderTy GetDegree(VertexTy v);
+
   virtual OrderTy GetOrder() = 0;
 
+  // Return a view over the adjacency if it is stored in CSR form with 32 bit or
+  // VertexTy wide vertex indices respectively, and null otherwise.  See
+  // graph_view.hpp.
+  virtual const CsrGraphView<CompactVertexTy> *GetCompactCsrView();
+  virtual const CsrGraphView<VertexTy> *GetWideCsrView();
+
+  // Returns a view over the adjacency if it is stored as a bit matrix, and null
+  // otherwise.
+  virtual const BitMatrixView *GetBitMatrixView();
+
   virtual std::unique_ptr<VertexIterator> GetVertices();
+
+  // Enumerates every undirected edge once, as (a, b) with a <= b, in order of
+  // `a`.  The default implementation reads edges in chunks through
+  // AppendUniqueEdges.
   virtual std::unique_ptr<EdgeIterator> GetEdges();
 
+  // Appends the edges (a, b) with a <= b for every `a` in [begin, end) to
+  // `*edges`, in the order GetEdges produces them.  Consumers that want bulk
+  // access, or that split the vertices into ranges with PartitionVertices to
+  // enumerate edges in parallel, should call this directly.
+  virtual void AppendUniqueEdges(VertexTy begin, VertexTy end,
+                                 std::vector<EdgeTy> *edges);
+
   virtual std::unique_ptr<Graph> Clone() = 0;
 };
 
@@ -88,10 +132,50 @@ Iterate(std::unique_ptr<Graph::VertexIterator> it) {
       std::move(it));
 }
 
+// Splits the vertices of `g` into `num_ranges` contiguous ranges of roughly
+// equal total degree and returns the `num_ranges + 1` range boundaries.
+std::vector<Graph::VertexTy> PartitionVertices(Graph *g, unsigned num_ranges);
+
+// Calls `fn` with successive chunks of the edges of `g`, in GetEdges order.
+// Every chunk but the last holds at least `chunk_size` edges.
+void ForEachEdgeChunk(
+    Graph *g, const std::function<void(std::span<const Graph::EdgeTy>)> &fn,
+    size_t chunk_size = 1 << 12);
+
+// Creates an immutable graph with the given undirected edges.  Repeated edges,
+// in either orientation, are collapsed.  Callers that know no edge is repeated
+// can pass `assume_unique` to skip the deduplication pass.
 std::unique_ptr<Graph> CreateConcreteGraph(Graph::OrderTy order,
-                                           std::span<Graph::EdgeTy> edges);
+                                           std::span<Graph::EdgeTy> edges,
+                                           bool assume_unique = false);
+
+// Creates an immutable graph from adjacency lists in CSR form: the neighbors of
+// vertex `v` are `neighbors[offsets[v]]` to `neighbors[offsets[v + 1]]`.  The
+// adjacency must be symmetric, but the lists need not be sorted and may repeat
+// neighbors.
+std::unique_ptr<Graph>
+CreateConcreteGraphFromAdjacency(std::vector<size_t> offsets,
+                                 std::vector<CompactVertexTy> neighbors);
+std::unique_ptr<Graph>
+CreateConcreteGraphFromAdjacency(std::vector<size_t> offsets,
+                                 std::vector<Graph::VertexTy> neighbors);
+
+using GraphOrError = std::variant<std::unique_ptr<Graph>, std::string>;
+
+struct ConsistencyCheckOptions {
+  // If set, only the adjacency lists of this many randomly chosen vertices are
+  // checked, against each other rather than against the edge list.  This
+  // catches asymmetric or out of range adjacency in time proportional to the
+  // sample, which makes it usable on graphs too large for a full check.
+  std::optional<size_t> sample_size;
+  unsigned seed = 1;
+};
 
-std::optional<std::string> CheckConsistency(Graph *g);
+// Checks that the edge list and the vertex adjacency lists of `g` describe the
+// same graph, and returns a description of every violation if they do not.
+// GetNeighbors is called from several threads at once.
+std::optional<std::string>
+CheckConsistency(Graph *g, const ConsistencyCheckOptions &options = {});
 
 std::ostream &operator<<(std::ostream &, const Graph::EdgeTy &);
 } // namespace kb
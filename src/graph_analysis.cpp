@@ -1,104 +1,682 @@
 #include "graph_analysis.hpp"
 
-#include "logging.hpp"
+#include "canonical.hpp"
+#include "graph_view.hpp"
+#include "parallel.hpp"
 
-#include <limits>
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
 
 namespace kb {
-std::optional<Graph::OrderTy> IsRegular(Graph *g) {
-  std::optional<Graph::OrderTy> degree;
-  for (auto vertex : Iterate(g->GetVertices())) {
-    Graph::OrderTy this_degree = 0;
-    for (auto edge : Iterate(g->GetEdgesContainingVertex(vertex))) {
-      (void)edge;
-      this_degree++;
-    }
+namespace {
+// The exact search fixes the membership of the highest kCheegerPrefixBits
+// vertices per task and enumerates the remaining vertices within the task.
+constexpr unsigned kCheegerPrefixBits = 10;
+
+// Below this many subsets the exact search runs on a single thread.
+constexpr std::uint64_t kCheegerSubsetGrain = 1 << 16;
+
+// A vertex set S of a graph with fewer than 64 vertices, together with the
+// number of neighbors every vertex has in S.  The vertex boundary of S is the
+// set of vertices outside S with at least one neighbor in it, so it can be
+// kept up to date in time proportional to the degree of a vertex entering or
+// leaving S.
+class IncrementalBoundary {
+public:
+  IncrementalBoundary(const std::vector<size_t> &offsets,
+                      const std::vector<Graph::VertexTy> &neighbors)
+      : offsets_(offsets), neighbors_(neighbors),
+        counters_(offsets.size() - 1, 0) {}
 
-    if (!degree) {
-      degree = this_degree;
-      continue;
+  void Flip(Graph::VertexTy v) {
+    std::uint64_t bit = std::uint64_t(1) << v;
+    if (set_ & bit) {
+      for (size_t i = offsets_[v], e = offsets_[v + 1]; i != e; i++)
+        if (--counters_[neighbors_[i]] == 0)
+          touched_ &= ~(std::uint64_t(1) << neighbors_[i]);
+    } else {
+      for (size_t i = offsets_[v], e = offsets_[v + 1]; i != e; i++)
+        if (counters_[neighbors_[i]]++ == 0)
+          touched_ |= std::uint64_t(1) << neighbors_[i];
     }
+    set_ ^= bit;
+  }
 
-    if (*degree != this_degree)
-      return std::nullopt;
+  Graph::OrderTy GetSize() const { return std::popcount(set_); }
+
+  Graph::OrderTy GetBoundarySize() const {
+    return std::popcount(touched_ & ~set_);
   }
 
-  return degree.value_or(0);
+private:
+  const std::vector<size_t> &offsets_;
+  const std::vector<Graph::VertexTy> &neighbors_;
+  std::vector<Graph::OrderTy> counters_;
+  // Bit `v` of `set_` is set if `v` is in S, and bit `v` of `touched_` if `v`
+  // has a neighbor in S.
+  std::uint64_t set_ = 0;
+  std::uint64_t touched_ = 0;
+};
+
+// boundary / size, compared exactly.
+struct CheegerRatio {
+  Graph::OrderTy boundary = 1;
+  Graph::OrderTy size = 0;
+
+  bool operator<(const CheegerRatio &other) const {
+    return std::uint64_t(boundary) * other.size <
+           std::uint64_t(other.boundary) * size;
+  }
+};
+
+// Random subsets are drawn in batches of kBitsPerWord, trial `t` of a batch
+// being bit `t` of the word drawn for every vertex.
+constexpr std::uint64_t kSubsetsPerBatch = kBitsPerWord;
+
+// Below this many adjacency entries visited per task the random subset search
+// runs on a single thread.
+constexpr std::uint64_t kSubsetSearchGrain = 1 << 16;
+
+std::uint64_t SplitMix64(std::uint64_t *state) {
+  std::uint64_t z = (*state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
 }
 
-static Graph::OrderTy PickRandomSubset(RandomBitGenerator *generator,
-                                       std::vector<bool> *set) {
-  Graph::OrderTy vertex_count = 0;
-  for (size_t i = 0, e = set->size(); i != e; i++) {
-    if (generator->Generate()) {
-      vertex_count++;
-      (*set)[i] = true;
-    } else {
-      (*set)[i] = false;
+// Below this many adjacency entries visited per task the lower bound
+// certificate runs its searches on a single thread.
+constexpr std::uint64_t kCertificateGrain = 1 << 20;
+
+// Counts, for each of the trials of a batch, how many of the words added so
+// far have that trial's bit set.  Bit `t` of `planes_[i]` is bit `i` of the
+// count of trial `t`, so adding a word is a ripple carry over the planes.
+class SlicedCounter {
+public:
+  explicit SlicedCounter(Graph::OrderTy max_count)
+      : planes_(std::bit_width(max_count), 0) {}
+
+  void Clear() { std::ranges::fill(planes_, 0); }
+
+  void Add(BitWord word) {
+    for (BitWord &plane : planes_) {
+      BitWord carry = plane & word;
+      plane ^= word;
+      word = carry;
+      if (word == 0)
+        break;
     }
   }
 
-  return vertex_count;
-}
+  Graph::OrderTy Get(unsigned trial) const {
+    Graph::OrderTy count = 0;
+    for (size_t i = 0, e = planes_.size(); i != e; i++)
+      count |= static_cast<Graph::OrderTy>((planes_[i] >> trial) & 1) << i;
+    return count;
+  }
+
+private:
+  std::vector<BitWord> planes_;
+};
+
+// Branch and bound search for a set of least boundary to size ratio.
+//
+// If a set splits into parts that are at distance three or more from each
+// other, the boundaries of the parts are disjoint and one of the parts has at
+// most the ratio of the whole.  So it is enough to search sets that are
+// connected in the square of the graph.  Every such set is generated once,
+// from its lowest vertex: each search node either adds a vertex within
+// distance two of the set, or excludes it from the rest of the subtree.
+class CheegerCutSearch {
+public:
+  CheegerCutSearch(Graph::OrderTy vertex_count, std::span<const BitWord> rows)
+      : vertex_count_(vertex_count), half_(vertex_count / 2),
+        words_per_row_(bitset::GetWordCount(vertex_count)), rows_(rows),
+        square_rows_(rows.begin(), rows.end()),
+        best_set_(words_per_row_, 0) {
+    for (Graph::VertexTy v = 0; v != vertex_count_; v++)
+      for (Graph::VertexTy n : bitset::ElementRange(GetRow(v)))
+        bitset::UnionWith(GetSquareRow(v), GetRow(n));
+  }
+
+  CheegerCut Run(const CheegerCutOptions &options) {
+    std::vector<Worker> workers(GetDefaultConcurrency());
+    workers_ = &workers;
+    for (Worker &worker : workers)
+      worker.frames.assign((half_ + 1) * kFrameSets * words_per_row_, 0);
+    SeedWithBalls();
+    SeedWithGreedyGrowth(&workers[0]);
+
+    // A set containing a vertex is the image under an automorphism of one
+    // containing the least vertex of its orbit, so only those are roots.
+    Graph::OrderTy roots = options.vertex_transitive
+                               ? std::min<Graph::OrderTy>(vertex_count_, 1)
+                               : vertex_count_;
+    std::vector<Graph::VertexTy> orbits;
+    if (!options.vertex_transitive)
+      ComputeCanonicalForm(vertex_count_, rows_, nullptr, &orbits);
+    std::vector<TaskQueue::Task> tasks;
+    for (Graph::VertexTy root = 0; root < roots && half_ != 0; root++) {
+      if (!orbits.empty() && orbits[root] != root)
+        continue;
+      std::vector<BitWord> frame(kFrameSets * words_per_row_, 0);
+      auto get_set = [&](FrameSet set) {
+        return std::span(frame).subspan(set * words_per_row_, words_per_row_);
+      };
+      bitset::Set(get_set(kSet), root);
+      bitset::UnionWith(get_set(kNeighborhood), GetRow(root));
+      bitset::UnionWith(get_set(kSquareNeighborhood), GetSquareRow(root));
+      for (Graph::VertexTy v = 0; v != root; v++)
+        bitset::Set(get_set(kExcluded), v);
+      tasks.push_back(MakeTask({std::move(frame), 0}));
+    }
+    RunWithWorkStealing(workers.size(), std::move(tasks));
+
+    CheegerCut cut;
+    if (best_.size == 0)
+      return cut;
+    for (Graph::VertexTy v : bitset::ElementRange(best_set_))
+      cut.set.push_back(v);
+    cut.boundary_size = best_.boundary;
+    cut.cheeger_constant = static_cast<double>(best_.boundary) /
+                           static_cast<double>(best_.size);
+    return cut;
+  }
+
+private:
+  // Each search frame holds the set, the union of the neighbors and of the
+  // vertices within distance two of its elements, and the vertices that may
+  // not be added.
+  enum FrameSet { kSet, kNeighborhood, kSquareNeighborhood, kExcluded };
+  static constexpr unsigned kFrameSets = 4;
+
+  // Subtrees are handed to idle workers only if their sets can still grow by
+  // at least this many vertices.
+  static constexpr Graph::OrderTy kMinSpawnedVertices = 4;
 
-static Graph::OrderTy FindBoundaryVertices(Graph *g,
-                                           const std::vector<bool> &vertices) {
-  Graph::OrderTy boundary_size = 0;
-  std::vector<bool> boundary_set(vertices.size(), false);
-  for (size_t i = 0, e = vertices.size(); i != e; i++) {
-    if (vertices[i]) {
-      for (auto e : Iterate(g->GetEdgesContainingVertex(i))) {
-        if (!vertices[e.second] && !boundary_set[e.second]) {
-          boundary_size++;
-          boundary_set[e.second] = true;
+  // The search state of one thread.
+  struct Worker {
+    std::vector<BitWord> frames;
+    std::vector<BitWord> scratch;
+    unsigned index = 0;
+    TaskQueue *queue = nullptr;
+  };
+
+  // A search node: the sets of its frame and its depth.
+  struct Subtree {
+    std::vector<BitWord> frame;
+    unsigned depth;
+  };
+
+  TaskQueue::Task MakeTask(Subtree subtree) {
+    return [this, subtree = std::move(subtree)](unsigned index,
+                                                TaskQueue *queue) {
+      Worker *worker = &(*workers_)[index];
+      worker->index = index;
+      worker->queue = queue;
+      std::ranges::copy(subtree.frame, GetFrame(worker, subtree.depth).begin());
+      Search(worker, subtree.depth);
+    };
+  }
+
+  std::span<const BitWord> GetRow(Graph::VertexTy v) const {
+    return rows_.subspan(v * words_per_row_, words_per_row_);
+  }
+
+  std::span<BitWord> GetSquareRow(Graph::VertexTy v) {
+    return std::span(square_rows_)
+        .subspan(v * words_per_row_, words_per_row_);
+  }
+
+  std::span<BitWord> GetFrame(Worker *worker, unsigned depth) {
+    return std::span(worker->frames)
+        .subspan(depth * kFrameSets * words_per_row_,
+                 kFrameSets * words_per_row_);
+  }
+
+  std::span<BitWord> GetFrameSet(Worker *worker, unsigned depth,
+                                 FrameSet set) {
+    return std::span(worker->frames)
+        .subspan((depth * kFrameSets + set) * words_per_row_, words_per_row_);
+  }
+
+  // The incumbent is read without the lock for pruning.  Sets have fewer than
+  // 64 vertices, so its boundary and size fit in one word.
+  CheegerRatio GetBest() const {
+    std::uint64_t packed = packed_best_.load(std::memory_order_relaxed);
+    return {static_cast<Graph::OrderTy>(packed >> 32),
+            static_cast<Graph::OrderTy>(packed & 0xffffffff)};
+  }
+
+  void Consider(std::span<const BitWord> set, CheegerRatio ratio) {
+    if (!(ratio < GetBest()))
+      return;
+    std::lock_guard<std::mutex> lock(best_mutex_);
+    if (ratio < best_) {
+      best_ = ratio;
+      std::ranges::copy(set, best_set_.begin());
+      packed_best_.store(std::uint64_t(ratio.boundary) << 32 | ratio.size,
+                         std::memory_order_relaxed);
+    }
+  }
+
+  // Seeds the incumbent with every prefix of a breadth first search, up to
+  // half the vertices, from every vertex.
+  void SeedWithBalls() {
+    std::vector<BitWord> set(words_per_row_), neighborhood(words_per_row_);
+    std::vector<BitWord> discovered(words_per_row_);
+    std::vector<Graph::VertexTy> queue;
+    for (Graph::VertexTy start = 0; start != vertex_count_; start++) {
+      std::ranges::fill(set, 0);
+      std::ranges::fill(neighborhood, 0);
+      std::ranges::fill(discovered, 0);
+      queue.assign(1, start);
+      bitset::Set(discovered, start);
+      for (size_t head = 0; head != queue.size() && head != half_; head++) {
+        Graph::VertexTy v = queue[head];
+        bitset::Set(set, v);
+        bitset::UnionWith(neighborhood, GetRow(v));
+        Consider(set, {bitset::CountDifference(neighborhood, set),
+                       static_cast<Graph::OrderTy>(head + 1)});
+        for (Graph::VertexTy n : bitset::ElementRange(GetRow(v))) {
+          if (!bitset::Test(discovered, n)) {
+            bitset::Set(discovered, n);
+            queue.push_back(n);
+          }
         }
       }
     }
   }
-  return boundary_size;
-}
 
-double DO_NOT_USE_ComputeCheegerConstantUpperBound(
-    Graph *g, RandomBitGenerator *generator, int num_iters) {
-  Graph::OrderTy vertex_count = g->GetOrder();
-  ;
+  // Seeds the incumbent with every prefix of a greedy growth, up to half the
+  // vertices, from every vertex, adding the vertex PickCandidate prefers.
+  void SeedWithGreedyGrowth(Worker *worker) {
+    std::vector<BitWord> set(words_per_row_), neighborhood(words_per_row_);
+    std::vector<BitWord> square(words_per_row_), excluded(words_per_row_, 0);
+    for (Graph::VertexTy start = 0; start != vertex_count_; start++) {
+      std::ranges::fill(set, 0);
+      std::ranges::fill(neighborhood, 0);
+      std::ranges::fill(square, 0);
+      Graph::VertexTy v = start;
+      for (Graph::OrderTy size = 1; size <= half_ && v != vertex_count_;
+           size++) {
+        bitset::Set(set, v);
+        bitset::UnionWith(neighborhood, GetRow(v));
+        bitset::UnionWith(square, GetSquareRow(v));
+        Consider(set, {bitset::CountDifference(neighborhood, set), size});
+        v = PickCandidate(worker, set, neighborhood, square, excluded);
+      }
+    }
+  }
 
-  double upper_bound = std::numeric_limits<double>::infinity();
+  // Returns the vertex to branch on next, or vertex_count_ if the set cannot
+  // grow.  Prefers boundary vertices that bring the fewest new vertices onto
+  // the boundary, since adding them is most likely to lower the ratio.
+  Graph::VertexTy PickCandidate(Worker *worker, std::span<const BitWord> set,
+                                std::span<const BitWord> neighborhood,
+                                std::span<const BitWord> square,
+                                std::span<const BitWord> excluded) {
 
-  std::vector<bool> selected_vertices(vertex_count);
-  for (int i = 0; i < num_iters; i++) {
-    Graph::OrderTy selected_vertex_count =
-        PickRandomSubset(generator, &selected_vertices);
+    std::vector<BitWord> &closed = worker->scratch;
+    closed.assign(set.begin(), set.end());
+    bitset::UnionWith(closed, neighborhood);
 
-    if (selected_vertex_count == vertex_count)
-      continue;
+    Graph::VertexTy best = vertex_count_;
+    Graph::OrderTy best_growth = std::numeric_limits<Graph::OrderTy>::max();
+    for (size_t i = 0; i != words_per_row_; i++) {
+      BitWord open = neighborhood[i] & ~set[i] & ~excluded[i];
+      for (; open != 0; open &= open - 1) {
+        Graph::VertexTy v = i * kBitsPerWord + std::countr_zero(open);
+        Graph::OrderTy growth = bitset::CountDifference(GetRow(v), closed);
+        if (growth < best_growth) {
+          best = v;
+          best_growth = growth;
+        }
+      }
+    }
+    if (best != vertex_count_)
+      return best;
 
-    if (selected_vertex_count > vertex_count / 2) {
-      selected_vertices.flip();
-      selected_vertex_count = vertex_count - selected_vertex_count;
+    for (size_t i = 0; i != words_per_row_; i++) {
+      BitWord open = square[i] & ~set[i] & ~excluded[i];
+      if (open != 0)
+        return i * kBitsPerWord + std::countr_zero(open);
     }
+    return vertex_count_;
+  }
+
+  // Searches the supersets of the set in frame `depth`, which has depth + 1
+  // vertices.  Children are handed to idle workers while the search runs.
+  void Search(Worker *worker, unsigned depth) {
+    std::span<BitWord> set = GetFrameSet(worker, depth, kSet);
+    std::span<BitWord> neighborhood = GetFrameSet(worker, depth, kNeighborhood);
+    std::span<BitWord> excluded = GetFrameSet(worker, depth, kExcluded);
+    Graph::OrderTy size = depth + 1;
+    Graph::OrderTy boundary = bitset::CountDifference(neighborhood, set);
+    Consider(set, {boundary, size});
+    if (size == half_)
+      return;
+
+    while (true) {
+      // Excluded boundary vertices stay on the boundary of every superset in
+      // this subtree.  The others can only leave it by joining the set, which
+      // is at most max_size vertices, so the ratio of any superset is at least
+      // `bound`.
+      Graph::OrderTy forced = bitset::CountIntersection(neighborhood, excluded);
+      Graph::OrderTy open = boundary - forced;
+      Graph::OrderTy available = vertex_count_ - size - bitset::Count(excluded);
+      Graph::OrderTy max_size = std::min(half_, size + available);
+      if (max_size == size)
+        return;
+      Graph::OrderTy growth = max_size - size;
+      CheegerRatio bound = {forced + (open > growth ? open - growth : 0),
+                            max_size};
+      if (!(bound < GetBest()))
+        return;
 
-    Graph::OrderTy boundary_vertices =
-        FindBoundaryVertices(g, selected_vertices);
-    double this_upper_bound = static_cast<double>(boundary_vertices) /
-                              static_cast<double>(selected_vertex_count);
-    upper_bound = std::min(upper_bound, this_upper_bound);
+      Graph::VertexTy candidate = PickCandidate(
+          worker, set, neighborhood,
+          GetFrameSet(worker, depth, kSquareNeighborhood), excluded);
+      if (candidate == vertex_count_)
+        return;
+
+      std::span<BitWord> child_set = GetFrameSet(worker, depth + 1, kSet);
+      std::ranges::copy(set, child_set.begin());
+      bitset::Set(child_set, candidate);
+      std::span<BitWord> child_neighborhood =
+          GetFrameSet(worker, depth + 1, kNeighborhood);
+      std::ranges::copy(neighborhood, child_neighborhood.begin());
+      bitset::UnionWith(child_neighborhood, GetRow(candidate));
+      std::span<BitWord> child_square =
+          GetFrameSet(worker, depth + 1, kSquareNeighborhood);
+      std::ranges::copy(GetFrameSet(worker, depth, kSquareNeighborhood),
+                        child_square.begin());
+      bitset::UnionWith(child_square, GetSquareRow(candidate));
+      std::ranges::copy(excluded,
+                        GetFrameSet(worker, depth + 1, kExcluded).begin());
+
+      if (half_ - (size + 1) >= kMinSpawnedVertices &&
+          worker->queue->HasIdleWorkers()) {
+        std::span<const BitWord> child = GetFrame(worker, depth + 1);
+        Subtree subtree = {{child.begin(), child.end()}, depth + 1};
+        worker->queue->Push(worker->index, MakeTask(std::move(subtree)));
+      } else {
+        Search(worker, depth + 1);
+      }
+
+      bitset::Set(excluded, candidate);
+    }
   }
 
-  return upper_bound;
+  Graph::OrderTy vertex_count_;
+  Graph::OrderTy half_;
+  size_t words_per_row_;
+  std::span<const BitWord> rows_;
+  std::vector<BitWord> square_rows_;
+  std::vector<Worker> *workers_ = nullptr;
+  std::mutex best_mutex_;
+  CheegerRatio best_;
+  std::vector<BitWord> best_set_;
+  std::atomic<std::uint64_t> packed_best_ = std::uint64_t(1) << 32;
+};
+} // namespace
+
+namespace detail {
+double DO_NOT_USE_ComputeCheegerConstantUpperBound(
+    const std::vector<size_t> &offsets,
+    const std::vector<Graph::VertexTy> &neighbors, std::uint64_t seed,
+    std::uint64_t num_subsets) {
+  Graph::OrderTy vertex_count = offsets.size() - 1;
+  Graph::OrderTy half = vertex_count / 2;
+  std::uint64_t batch_count =
+      (num_subsets + kSubsetsPerBatch - 1) / kSubsetsPerBatch;
+  unsigned tasks = GetTaskCount(batch_count * (neighbors.size() + 1),
+                                kSubsetSearchGrain);
+
+  std::vector<CheegerRatio> task_minimums(tasks);
+  auto search = [&](unsigned task, size_t begin, size_t end) {
+    std::vector<BitWord> in_set(vertex_count);
+    SlicedCounter sizes(vertex_count);
+    SlicedCounter boundaries(vertex_count);
+    SlicedCounter complement_boundaries(vertex_count);
+    CheegerRatio minimum;
+    for (std::uint64_t batch = begin; batch != end; batch++) {
+      // Every batch continues the stream from where the previous one stopped,
+      // so the subsets do not depend on how batches are split over tasks.
+      std::uint64_t state = seed + batch * vertex_count * 0x9e3779b97f4a7c15;
+      sizes.Clear();
+      boundaries.Clear();
+      complement_boundaries.Clear();
+      for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+        in_set[v] = SplitMix64(&state);
+        sizes.Add(in_set[v]);
+      }
+
+      // A vertex is on the boundary of a set if it is outside it and has a
+      // neighbor inside it, and likewise for the complement.
+      for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+        BitWord any_in = 0;
+        BitWord any_out = 0;
+        for (size_t i = offsets[v], e = offsets[v + 1]; i != e; i++) {
+          any_in |= in_set[neighbors[i]];
+          any_out |= ~in_set[neighbors[i]];
+        }
+        boundaries.Add(any_in & ~in_set[v]);
+        complement_boundaries.Add(any_out & in_set[v]);
+      }
+
+      unsigned trials = std::min(num_subsets - batch * kSubsetsPerBatch,
+                                 kSubsetsPerBatch);
+      for (unsigned trial = 0; trial != trials; trial++) {
+        Graph::OrderTy size = sizes.Get(trial);
+        CheegerRatio ratio = {boundaries.Get(trial), size};
+        if (size != 0 && size <= half && ratio < minimum)
+          minimum = ratio;
+        CheegerRatio complement_ratio = {complement_boundaries.Get(trial),
+                                         vertex_count - size};
+        if (size != vertex_count && vertex_count - size <= half &&
+            complement_ratio < minimum)
+          minimum = complement_ratio;
+      }
+    }
+    task_minimums[task] = minimum;
+  };
+  ParallelFor(batch_count, tasks, search);
+
+  CheegerRatio minimum;
+  for (const CheegerRatio &ratio : task_minimums)
+    if (ratio < minimum)
+      minimum = ratio;
+  if (minimum.size == 0)
+    return std::numeric_limits<double>::infinity();
+  return static_cast<double>(minimum.boundary) /
+         static_cast<double>(minimum.size);
 }
 
-static int IntegerToBits(unsigned long input, std::vector<bool> *output) {
-  int set_bits = 0;
-  for (int i = 0, e = output->size(); i != e; i++) {
-    (*output)[i] = input % 2 == 1;
-    if (input % 2 == 1)
-      set_bits++;
-    input /= 2;
+CheegerLowerBound
+CertifyCheegerLowerBound(const std::vector<size_t> &offsets,
+                         const std::vector<Graph::VertexTy> &neighbors) {
+  Graph::OrderTy vertex_count = offsets.size() - 1;
+  CheegerLowerBound result;
+  if (vertex_count < 2)
+    return result;
+
+  // Every pair is routed half from each end, so each search routes one half
+  // unit from its source to every other vertex.
+  constexpr unsigned kUnreached = -1;
+  unsigned tasks = GetTaskCount(
+      std::uint64_t(vertex_count) * (vertex_count + neighbors.size()),
+      kCertificateGrain);
+  std::vector<std::vector<double>> task_loads(tasks);
+  std::vector<char> task_disconnected(tasks, false);
+  auto route = [&](unsigned task, size_t begin, size_t end) {
+    std::vector<double> &loads = task_loads[task];
+    loads.assign(vertex_count, 0);
+    std::vector<unsigned> distance(vertex_count, kUnreached);
+    std::vector<unsigned> predecessors(vertex_count, 0);
+    std::vector<double> shares(vertex_count);
+    std::vector<Graph::VertexTy> queue;
+    queue.reserve(vertex_count);
+    for (Graph::VertexTy source = begin; source != end; source++) {
+      queue.assign(1, source);
+      distance[source] = 0;
+      for (size_t head = 0; head != queue.size(); head++) {
+        Graph::VertexTy v = queue[head];
+        unsigned next = distance[v] + 1;
+        for (size_t i = offsets[v], e = offsets[v + 1]; i != e; i++) {
+          Graph::VertexTy n = neighbors[i];
+          if (distance[n] == kUnreached) {
+            distance[n] = next;
+            queue.push_back(n);
+          }
+          predecessors[n] += distance[n] == next;
+        }
+      }
+      if (queue.size() != vertex_count)
+        task_disconnected[task] = true;
+
+      // Walk back from the farthest vertices.  Each one carries the flow
+      // ending at it plus the shares of its successors, and passes that on to
+      // its predecessors in equal shares.
+      for (size_t index = queue.size() - 1; index != 0; index--) {
+        Graph::VertexTy v = queue[index];
+        unsigned next = distance[v] + 1;
+        double through = 0.5;
+        for (size_t i = offsets[v], e = offsets[v + 1]; i != e; i++)
+          if (distance[neighbors[i]] == next)
+            through += shares[neighbors[i]];
+        loads[v] += through;
+        shares[v] = through / predecessors[v];
+      }
+
+      for (Graph::VertexTy v : queue) {
+        distance[v] = kUnreached;
+        predecessors[v] = 0;
+      }
+    }
+  };
+  ParallelFor(vertex_count, tasks, route);
+
+  // Each vertex is also the source of half a unit to every other vertex.
+  std::vector<double> loads(vertex_count, 0.5 * (vertex_count - 1));
+  for (const std::vector<double> &task_load : task_loads)
+    for (Graph::VertexTy v = 0; v != vertex_count; v++)
+      loads[v] += task_load[v];
+  auto most_loaded = std::max_element(loads.begin(), loads.end());
+  result.max_vertex_load = *most_loaded;
+  result.most_loaded_vertex = most_loaded - loads.begin();
+  if (std::ranges::find(task_disconnected, true) == task_disconnected.end()) {
+    // Every load is a sum of positive terms, each at most `depth` roundings
+    // away from exact values: a share is a quotient of sums along a shortest
+    // path, and the loads add up one share per source and one per task.  So
+    // the computed load is within a factor 1 + gamma of the exact one, where
+    // gamma = depth * u / (1 - depth * u) for the unit roundoff u.  The load
+    // is scaled up by twice that, to cover rounding in gamma itself, and the
+    // quotient is rounded towards zero.
+    Graph::OrderTy max_degree = 0;
+    for (Graph::VertexTy v = 0; v != vertex_count; v++)
+      max_degree = std::max<Graph::OrderTy>(max_degree,
+                                            offsets[v + 1] - offsets[v]);
+    double depth = static_cast<double>(vertex_count) * (max_degree + 3) + tasks;
+    double roundoff = depth * std::numeric_limits<double>::epsilon() / 2;
+    if (roundoff < 0.25) {
+      double gamma = roundoff / (1 - roundoff);
+      double load = std::nextafter(result.max_vertex_load * (1 + 2 * gamma),
+                                   std::numeric_limits<double>::infinity());
+      result.cheeger_lower_bound = std::nextafter(
+          static_cast<double>(vertex_count - vertex_count / 2) / load, 0.0);
+    }
   }
-  assert(input == 0 && "output vector is too small!");
-  return set_bits;
+  LOG_VAR(result.max_vertex_load);
+  return result;
+}
+
+CheegerCut ComputeExactCheegerCut(Graph::OrderTy vertex_count,
+                                  std::span<const BitWord> rows,
+                                  const CheegerCutOptions &options) {
+  CheegerCutSearch search(vertex_count, rows);
+  CheegerCut cut = search.Run(options);
+  LOG_VAR(cut.set.size());
+  LOG_VAR(cut.boundary_size);
+  return cut;
+}
+
+double
+ComputeExactCheegerConstant(const std::vector<size_t> &offsets,
+                            const std::vector<Graph::VertexTy> &neighbors) {
+  Graph::OrderTy vertex_count = offsets.size() - 1;
+  assert(vertex_count < 64 && "Too many vertices for an exact search");
+  LOG_VAR(vertex_count);
+
+  // Each task starts from one assignment of the prefix vertices and walks the
+  // others in Gray code order, so consecutive subsets differ by one vertex.
+  unsigned prefix_bits = std::min<unsigned>(vertex_count, kCheegerPrefixBits);
+  unsigned suffix_bits = vertex_count - prefix_bits;
+  std::uint64_t prefix_count = std::uint64_t(1) << prefix_bits;
+  unsigned tasks = GetTaskCount(std::uint64_t(1) << vertex_count,
+                                kCheegerSubsetGrain);
+  std::vector<CheegerRatio> task_minimums(tasks);
+  auto search = [&](unsigned task, size_t begin, size_t end) {
+    CheegerRatio minimum;
+    auto consider = [&](const IncrementalBoundary &state) {
+      Graph::OrderTy size = state.GetSize();
+      if (size == 0 || size > vertex_count / 2)
+        return;
+      CheegerRatio ratio = {state.GetBoundarySize(), size};
+      if (ratio < minimum)
+        minimum = ratio;
+    };
+
+    for (size_t prefix = begin; prefix != end; prefix++) {
+      IncrementalBoundary state(offsets, neighbors);
+      for (unsigned i = 0; i != prefix_bits; i++)
+        if ((prefix >> i) & 1)
+          state.Flip(suffix_bits + i);
+      consider(state);
+
+      for (std::uint64_t i = 1, e = std::uint64_t(1) << suffix_bits; i != e;
+           i++) {
+        state.Flip(std::countr_zero(i));
+        consider(state);
+      }
+    }
+    task_minimums[task] = minimum;
+  };
+  ParallelFor(prefix_count, tasks, search);
+
+  CheegerRatio minimum;
+  for (const CheegerRatio &ratio : task_minimums)
+    if (ratio < minimum)
+      minimum = ratio;
+
+  LOG_VAR(minimum.size);
+  LOG_VAR(minimum.boundary);
+  if (minimum.size == 0)
+    return std::numeric_limits<double>::infinity();
+  return static_cast<double>(minimum.boundary) /
+         static_cast<double>(minimum.size);
+}
+} // namespace detail
+
+std::optional<Graph::OrderTy> IsRegular(Graph *g) {
+  return VisitGraphView(g, [](const auto &view) { return IsRegular(view); });
+}
+
+std::vector<Graph::OrderTy> ComputeDegreeHistogram(Graph *g) {
+  return VisitGraphView(
+      g, [](const auto &view) { return ComputeDegreeHistogram(view); });
+}
+
+double DO_NOT_USE_ComputeCheegerConstantUpperBound(
+    Graph *g, RandomBitGenerator *generator, int num_iters) {
+  return VisitGraphView(g, [&](const auto &view) {
+    return DO_NOT_USE_ComputeCheegerConstantUpperBound(view, generator,
+                                                       num_iters);
+  });
 }
 
 std::ostream &operator<<(std::ostream &os,
@@ -117,47 +695,23 @@ std::ostream &operator<<(std::ostream &os,
   return os;
 }
 
-double ComputeExactCheegerConstant(Graph *g) {
-  Graph::OrderTy vertex_count = g->GetOrder();
-
-  double upper_bound = std::numeric_limits<double>::infinity();
-  Graph::OrderTy selected_vertex_count_for_min = -1;
-  Graph::OrderTy boundary_vertices_for_min = -1;
-
-  int total_combinations = 1u << vertex_count;
-  std::vector<bool> selected_vertices(vertex_count);
-
-  LOG_VAR(vertex_count);
-
-  for (unsigned i = 1; i != total_combinations; i++) {
-    Graph::OrderTy selected_vertex_count = IntegerToBits(i, &selected_vertices);
-    if (selected_vertex_count > vertex_count / 2)
-      continue;
-
-    Graph::OrderTy boundary_vertices =
-        FindBoundaryVertices(g, selected_vertices);
-    double this_upper_bound = static_cast<double>(boundary_vertices) /
-                              static_cast<double>(selected_vertex_count);
-
-    assert(boundary_vertices <= (vertex_count - selected_vertex_count) &&
-           "Cannot have more boundary vertices that the number of vertices "
-           "outside "
-           "the region!");
-    LOG_VAR(selected_vertex_count);
-    LOG_VAR(selected_vertices);
-    LOG_VAR(boundary_vertices);
-
-    if (this_upper_bound < upper_bound) {
-      upper_bound = this_upper_bound;
-      selected_vertex_count_for_min = selected_vertex_count;
-      boundary_vertices_for_min = boundary_vertices;
-    }
-    upper_bound = std::min(upper_bound, this_upper_bound);
-  }
+CheegerCut ComputeExactCheegerCut(Graph *g, const CheegerCutOptions &options) {
+  return VisitGraphView(g, [&](const auto &view) {
+    return ComputeExactCheegerCut(view, options);
+  });
+}
 
-  LOG_VAR(selected_vertex_count_for_min);
-  LOG_VAR(boundary_vertices_for_min);
+CheegerLowerBound CertifyCheegerLowerBound(Graph *g) {
+  return VisitGraphView(g, [](const auto &view) {
+    std::vector<size_t> offsets;
+    std::vector<Graph::VertexTy> neighbors;
+    detail::FlattenAdjacency(view, &offsets, &neighbors);
+    return detail::CertifyCheegerLowerBound(offsets, neighbors);
+  });
+}
 
-  return upper_bound;
+double ComputeExactCheegerConstant(Graph *g) {
+  return VisitGraphView(
+      g, [](const auto &view) { return ComputeExactCheegerConstant(view); });
 }
 } // namespace kb
@@ -1,15 +1,226 @@
 #pragma once
 
+#include "bitset.hpp"
 #include "graph.hpp"
+#include "graph_view.hpp"
+#include "logging.hpp"
 #include "random.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
 namespace kb {
 std::optional<Graph::OrderTy> IsRegular(Graph *g);
 
+// Returns the number of vertices of each degree, indexed by degree.  The last
+// entry is nonzero unless the graph is empty.
+std::vector<Graph::OrderTy> ComputeDegreeHistogram(Graph *g);
+
 // Unclear how to get good probabilistic bounds on the cheeger constant.
+//
+// Evaluates `num_iters` random subsets and their complements.  The subsets
+// are drawn 64 at a time, one per bit of a word held for every vertex, and
+// the batches are spread over GetDefaultConcurrency() threads.
 double DO_NOT_USE_ComputeCheegerConstantUpperBound(
     Graph *g, RandomBitGenerator *generator, int num_iters);
 
-// Runs in exponential time.
+// Visits all 2^order vertex subsets, spread over GetDefaultConcurrency()
+// threads, so it is practical up to about 40 vertices.  The graph must have
+// fewer than 64 vertices.
 double ComputeExactCheegerConstant(Graph *g);
+
+// A set of vertices attaining the Cheeger constant, the least ratio between
+// the number of vertices on the boundary of a set and the size of the set,
+// over nonempty sets of at most half the vertices.
+struct CheegerCut {
+  std::vector<Graph::VertexTy> set;
+  Graph::OrderTy boundary_size = 0;
+  double cheeger_constant = std::numeric_limits<double>::infinity();
+};
+
+struct CheegerCutOptions {
+  // The caller knows that every vertex can be mapped onto every other one by
+  // an automorphism, so only sets containing vertex 0 are searched.
+  // Otherwise the orbits are computed, and sets are searched from the least
+  // vertex of each.
+  bool vertex_transitive = false;
+};
+
+// Finds a set attaining the same value as ComputeExactCheegerConstant by
+// branch and bound, growing sets one vertex at a time from their lowest
+// vertex, with subtrees spread over GetDefaultConcurrency() workers.  Runs in
+// exponential time, so it is practical up to about 50 vertices.
+CheegerCut ComputeExactCheegerCut(Graph *g,
+                                  const CheegerCutOptions &options = {});
+
+// A lower bound on the Cheeger constant certified by routing one unit of flow
+// between every pair of vertices, split evenly over the shortest path
+// predecessors of every vertex.  A set S of at most half the vertices
+// separates at least |S| * ceil(order / 2) pairs, and the flow of each of
+// them passes through a vertex on the boundary of S, so
+// |∂S| / |S| >= ceil(order / 2) / max_vertex_load.
+struct CheegerLowerBound {
+  // Zero if the graph is disconnected or has fewer than two vertices.  The
+  // quotient is rounded down far enough to cover floating point error in
+  // the loads, so it never exceeds the exact one.
+  double cheeger_lower_bound = 0;
+
+  // The largest flow through, into or out of a single vertex, and a vertex
+  // carrying it.
+  double max_vertex_load = 0;
+  Graph::VertexTy most_loaded_vertex = 0;
+};
+
+// Runs a breadth first search from every vertex, spread over
+// GetDefaultConcurrency() threads, so it takes O(order * size) time.
+CheegerLowerBound CertifyCheegerLowerBound(Graph *g);
+
+std::ostream &operator<<(std::ostream &os, const std::vector<bool> &vertex_set);
+
+// The functions below are the statically dispatched kernels behind the entry
+// points above.  They can be called directly on a GraphView to avoid a
+// virtual call per vertex.
+
+template <GraphView G> std::optional<Graph::OrderTy> IsRegular(const G &g) {
+  std::optional<Graph::OrderTy> degree;
+  for (Graph::VertexTy vertex = 0, e = g.GetOrder(); vertex != e; vertex++) {
+    Graph::OrderTy this_degree = g.GetDegree(vertex);
+
+    if (!degree) {
+      degree = this_degree;
+      continue;
+    }
+
+    if (*degree != this_degree)
+      return std::nullopt;
+  }
+
+  return degree.value_or(0);
+}
+
+template <GraphView G>
+std::vector<Graph::OrderTy> ComputeDegreeHistogram(const G &g) {
+  std::vector<Graph::OrderTy> histogram;
+  for (Graph::VertexTy vertex = 0, e = g.GetOrder(); vertex != e; vertex++) {
+    Graph::OrderTy degree = g.GetDegree(vertex);
+    if (degree >= histogram.size())
+      histogram.resize(degree + 1, 0);
+    histogram[degree]++;
+  }
+  return histogram;
+}
+
+namespace detail {
+// Copies the adjacency lists of `g` into one flat array, for kernels that
+// walk them many times.
+template <GraphView G>
+void FlattenAdjacency(const G &g, std::vector<size_t> *offsets,
+                      std::vector<Graph::VertexTy> *neighbors) {
+  offsets->assign(1, 0);
+  neighbors->clear();
+  for (Graph::VertexTy vertex = 0, e = g.GetOrder(); vertex != e; vertex++) {
+    for (Graph::VertexTy n : g.GetNeighbors(vertex))
+      neighbors->push_back(n);
+    offsets->push_back(neighbors->size());
+  }
+}
+
+template <GraphView G>
+Graph::OrderTy FindBoundaryVertices(const G &g,
+                                    const std::vector<bool> &vertices) {
+  if constexpr (std::same_as<G, BitMatrixView>) {
+    // The boundary is the union of the rows of the set, minus the set.
+    std::vector<BitWord> set(g.GetWordsPerRow(), 0);
+    std::vector<BitWord> neighborhood(g.GetWordsPerRow(), 0);
+    for (size_t i = 0, e = vertices.size(); i != e; i++)
+      if (vertices[i])
+        bitset::Set(set, i);
+    for (Graph::VertexTy v : bitset::ElementRange(set))
+      bitset::UnionWith(neighborhood, g.GetRow(v));
+    return bitset::CountDifference(neighborhood, set);
+  }
+
+  Graph::OrderTy boundary_size = 0;
+  std::vector<bool> boundary_set(vertices.size(), false);
+  for (size_t i = 0, e = vertices.size(); i != e; i++) {
+    if (vertices[i]) {
+      for (Graph::VertexTy n : g.GetNeighbors(i)) {
+        if (!vertices[n] && !boundary_set[n]) {
+          boundary_size++;
+          boundary_set[n] = true;
+        }
+      }
+    }
+  }
+  return boundary_size;
+}
+
+// Returns the least ratio found over `num_subsets` random subsets, and their
+// complements, of the graph with the given adjacency lists.  The subsets are
+// drawn from a fixed stream determined by `seed`.
+double DO_NOT_USE_ComputeCheegerConstantUpperBound(
+    const std::vector<size_t> &offsets,
+    const std::vector<Graph::VertexTy> &neighbors, std::uint64_t seed,
+    std::uint64_t num_subsets);
+
+// Returns the exact Cheeger constant of the graph with the given adjacency
+// lists, which has fewer than 64 vertices.
+double
+ComputeExactCheegerConstant(const std::vector<size_t> &offsets,
+                            const std::vector<Graph::VertexTy> &neighbors);
+
+// Returns the certificate described at CheegerLowerBound for the graph with
+// the given adjacency lists.
+CheegerLowerBound
+CertifyCheegerLowerBound(const std::vector<size_t> &offsets,
+                         const std::vector<Graph::VertexTy> &neighbors);
+
+// Returns an optimal set of the graph whose adjacency is given as rows of a
+// bit matrix, as in BitMatrixView.
+CheegerCut ComputeExactCheegerCut(Graph::OrderTy vertex_count,
+                                  std::span<const BitWord> rows,
+                                  const CheegerCutOptions &options);
+} // namespace detail
+
+template <GraphView G>
+double DO_NOT_USE_ComputeCheegerConstantUpperBound(
+    const G &g, RandomBitGenerator *generator, int num_iters) {
+  std::vector<size_t> offsets;
+  std::vector<Graph::VertexTy> neighbors;
+  detail::FlattenAdjacency(g, &offsets, &neighbors);
+
+  std::uint64_t seed = 0;
+  for (int i = 0; i != 64; i++)
+    seed = seed << 1 | generator->Generate();
+  return detail::DO_NOT_USE_ComputeCheegerConstantUpperBound(
+      offsets, neighbors, seed, std::max(num_iters, 0));
+}
+
+template <GraphView G> double ComputeExactCheegerConstant(const G &g) {
+  std::vector<size_t> offsets;
+  std::vector<Graph::VertexTy> neighbors;
+  detail::FlattenAdjacency(g, &offsets, &neighbors);
+  return detail::ComputeExactCheegerConstant(offsets, neighbors);
+}
+
+template <GraphView G>
+CheegerCut ComputeExactCheegerCut(const G &g,
+                                  const CheegerCutOptions &options = {}) {
+  Graph::OrderTy vertex_count = g.GetOrder();
+  size_t words_per_row = bitset::GetWordCount(vertex_count);
+  std::vector<BitWord> rows(vertex_count * words_per_row, 0);
+  for (Graph::VertexTy vertex = 0; vertex != vertex_count; vertex++) {
+    std::span<BitWord> row =
+        std::span(rows).subspan(vertex * words_per_row, words_per_row);
+    for (Graph::VertexTy n : g.GetNeighbors(vertex))
+      bitset::Set(row, n);
+  }
+  return detail::ComputeExactCheegerCut(vertex_count, rows, options);
+}
 } // namespace kb
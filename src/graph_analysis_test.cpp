@@ -1,8 +1,12 @@
 #include "graph_analysis.hpp"
+#include "graph_zoo.hpp"
+#include "parallel.hpp"
 #include "random.hpp"
 #include "random_graph.hpp"
 #include "test.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 using namespace kb;
@@ -47,6 +51,18 @@ static void TestIsRegular_IrregularGraph() {
   CHECK(!degree.has_value());
 }
 
+static void TestComputeDegreeHistogram() {
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 1}, {0, 2}, {1, 2}, {3, 4},
+  };
+  std::unique_ptr<Graph> graph = CreateConcreteGraph(6, edges);
+  std::vector<Graph::OrderTy> expected = {1, 2, 2, 1};
+  CHECK(ComputeDegreeHistogram(graph.get()) == expected);
+
+  VirtualGraphView virtual_view(graph.get());
+  CHECK(ComputeDegreeHistogram(virtual_view) == expected);
+}
+
 static void TestComputeExactCheegerConstant_Ring4() {
   std::vector<Graph::EdgeTy> edges = {
       {0, 1},
@@ -163,11 +179,192 @@ static void TestComputeExactCheegerConstant_AlmostK10() {
   CHECK_EQ(cheeger_constant, 1.0);
 }
 
+// Recomputes the boundary of every subset from scratch.
+static double ComputeCheegerConstantByBruteForce(Graph *g) {
+  Graph::OrderTy vertex_count = g->GetOrder();
+  VirtualGraphView view(g);
+  double minimum = std::numeric_limits<double>::infinity();
+  std::vector<bool> vertices(vertex_count);
+  for (unsigned long subset = 1; subset != 1ul << vertex_count; subset++) {
+    Graph::OrderTy size = 0;
+    for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+      vertices[v] = (subset >> v) & 1;
+      size += vertices[v];
+    }
+    if (size > vertex_count / 2)
+      continue;
+    minimum = std::min(minimum,
+                       static_cast<double>(
+                           detail::FindBoundaryVertices(view, vertices)) /
+                           size);
+  }
+  return minimum;
+}
+
+static void TestComputeExactCheegerConstant_MatchesBruteForce() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  for (Graph::OrderTy order : {1, 2, 7, 12, 13}) {
+    std::unique_ptr<Graph> g = CreateRandomSparseGraph(
+        rbg.get(), order, 3, /*ensure_connected=*/false);
+    CHECK_EQ(ComputeExactCheegerConstant(g.get()),
+             ComputeCheegerConstantByBruteForce(g.get()));
+  }
+
+  std::vector<Graph::EdgeTy> edges = {{0, 0}, {0, 1}, {1, 2}, {2, 3},
+                                      {3, 3}, {3, 4}, {4, 5}, {5, 0}};
+  std::unique_ptr<Graph> g = CreateConcreteGraph(6, edges);
+  CHECK_EQ(ComputeExactCheegerConstant(g.get()),
+           ComputeCheegerConstantByBruteForce(g.get()));
+}
+
+static void TestComputeExactCheegerConstant_Ring24_Parallel() {
+  std::vector<Graph::EdgeTy> edges;
+  for (Graph::VertexTy i = 0; i < 24; i++)
+    edges.push_back({i, (i + 1) % 24});
+  std::unique_ptr<Graph> ring_graph = CreateConcreteGraph(24, edges);
+
+  SetDefaultConcurrency(4);
+  double cheeger_constant = ComputeExactCheegerConstant(ring_graph.get());
+  SetDefaultConcurrency(0);
+  CHECK_EQ(cheeger_constant, 2.0 / 12.0);
+}
+
+// Checks that `cut` is a valid set with the claimed ratio.
+static void CheckCheegerCut(Graph *g, const CheegerCut &cut) {
+  std::vector<bool> vertices(g->GetOrder(), false);
+  for (Graph::VertexTy v : cut.set)
+    vertices[v] = true;
+  CHECK_GT(cut.set.size(), 0);
+  CHECK_LE(cut.set.size(), g->GetOrder() / 2);
+  CHECK_EQ(detail::FindBoundaryVertices(VirtualGraphView(g), vertices),
+           cut.boundary_size);
+  CHECK_EQ(cut.cheeger_constant,
+           static_cast<double>(cut.boundary_size) / cut.set.size());
+}
+
+static void TestComputeExactCheegerCut_MatchesExhaustiveSearch() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  for (Graph::OrderTy order = 2; order <= 16; order++) {
+    for (Graph::OrderTy degree : {2, 3, 5}) {
+      std::unique_ptr<Graph> g = CreateRandomSparseGraph(
+          rbg.get(), order, degree, /*ensure_connected=*/order % 2 == 0);
+      CheegerCut cut = ComputeExactCheegerCut(g.get());
+      CHECK_EQ(cut.cheeger_constant, ComputeExactCheegerConstant(g.get()));
+      CheckCheegerCut(g.get(), cut);
+    }
+  }
+
+  std::unique_ptr<Graph> complete_graph = CreateCompleteGraph(9, true);
+  CheegerCut cut = ComputeExactCheegerCut(complete_graph.get(),
+                                          {.vertex_transitive = true});
+  CHECK_EQ(cut.cheeger_constant, 1.25);
+  CheckCheegerCut(complete_graph.get(), cut);
+
+  std::unique_ptr<Graph> single_vertex = CreateCompleteGraph(1, false);
+  CHECK_EQ(ComputeExactCheegerCut(single_vertex.get()).cheeger_constant,
+           ComputeExactCheegerConstant(single_vertex.get()));
+}
+
+static void TestComputeExactCheegerCut_ReplacementProduct() {
+  // 42 vertices, well past the reach of the exhaustive search.  Its
+  // automorphisms leave three orbits of vertices, so only three roots are
+  // searched, and some optimal set contains vertex 0.
+  std::unique_ptr<Graph> product = CreateReplacementProduct(
+      CreateCompleteGraph(7, false), CreateRingGraph(6));
+  CHECK_EQ(product->GetOrder(), 42);
+  CheegerCut cut = ComputeExactCheegerCut(product.get());
+  CheckCheegerCut(product.get(), cut);
+  CHECK_EQ(cut.cheeger_constant, 9.0 / 21.0);
+
+  CheegerCut transitive_cut =
+      ComputeExactCheegerCut(product.get(), {.vertex_transitive = true});
+  CheckCheegerCut(product.get(), transitive_cut);
+  CHECK_EQ(transitive_cut.cheeger_constant, cut.cheeger_constant);
+}
+
+static void TestCheegerConstantUpperBound() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), 12, 3);
+  double exact = ComputeExactCheegerConstant(g.get());
+
+  // 4096 subsets cover a good share of the 4096 subsets of 12 vertices.
+  double upper_bound =
+      DO_NOT_USE_ComputeCheegerConstantUpperBound(g.get(), rbg.get(), 4096);
+  CHECK_EQ(upper_bound, exact);
+
+  // A partial last batch only counts the requested number of subsets.
+  CHECK_GE(DO_NOT_USE_ComputeCheegerConstantUpperBound(g.get(), rbg.get(), 3),
+           exact);
+  CHECK_EQ(DO_NOT_USE_ComputeCheegerConstantUpperBound(g.get(), rbg.get(), 0),
+           std::numeric_limits<double>::infinity());
+
+  // The subsets only depend on the generator, not on the number of threads.
+  std::unique_ptr<Graph> ring_graph = CreateRingGraph(100);
+  auto first = CreateDefaultRandomBitGenerator(/*seed=*/7);
+  auto second = CreateDefaultRandomBitGenerator(/*seed=*/7);
+  double sequential = DO_NOT_USE_ComputeCheegerConstantUpperBound(
+      ring_graph.get(), first.get(), 1 << 12);
+  SetDefaultConcurrency(4);
+  double parallel = DO_NOT_USE_ComputeCheegerConstantUpperBound(
+      ring_graph.get(), second.get(), 1 << 12);
+  SetDefaultConcurrency(0);
+  CHECK_EQ(sequential, parallel);
+  CHECK_GE(sequential, 4.0 / 100.0);
+}
+
+static void TestCertifyCheegerLowerBound() {
+  // Every vertex of K_n carries its own n - 1 pairs and nothing else.
+  std::unique_ptr<Graph> complete_graph = CreateCompleteGraph(9, true);
+  CheegerLowerBound bound = CertifyCheegerLowerBound(complete_graph.get());
+  CHECK_EQ(bound.max_vertex_load, 8);
+  // The bound is rounded down to cover floating point error in the loads.
+  CHECK_LE(bound.cheeger_lower_bound, 5.0 / 8.0);
+  CHECK_GT(bound.cheeger_lower_bound, 5.0 / 8.0 * (1 - 1e-12));
+
+  auto rbg = CreateDefaultRandomBitGenerator();
+  for (Graph::OrderTy order : {6, 11, 16}) {
+    std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), order, 3);
+    bound = CertifyCheegerLowerBound(g.get());
+    CHECK_GT(bound.cheeger_lower_bound, 0);
+    CHECK_LE(bound.cheeger_lower_bound, ComputeExactCheegerConstant(g.get()));
+  }
+
+  std::vector<Graph::EdgeTy> edges;
+  for (Graph::VertexTy i = 0; i < 24; i++)
+    edges.push_back({i, (i + 1) % 24});
+  std::unique_ptr<Graph> ring_graph = CreateConcreteGraph(24, edges);
+  SetDefaultConcurrency(4);
+  bound = CertifyCheegerLowerBound(ring_graph.get());
+  SetDefaultConcurrency(0);
+  CHECK_LE(bound.cheeger_lower_bound, 2.0 / 12.0);
+  CHECK_GE(bound.cheeger_lower_bound, 1.0 / 12.0);
+
+  std::unique_ptr<Graph> unconnected_graph = CreateUnconnectedGraph(5);
+  bound = CertifyCheegerLowerBound(unconnected_graph.get());
+  CHECK_EQ(bound.cheeger_lower_bound, 0);
+}
+
+static void TestStaticAndVirtualViewsAgree() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), 12, 3);
+
+  const CsrGraphView<CompactVertexTy> *csr_view = g->GetCompactCsrView();
+  CHECK(csr_view != nullptr);
+  VirtualGraphView virtual_view(g.get());
+
+  CHECK(IsRegular(*csr_view) == IsRegular(virtual_view));
+  CHECK_EQ(ComputeExactCheegerConstant(*csr_view),
+           ComputeExactCheegerConstant(virtual_view));
+  CHECK_EQ(ComputeExactCheegerConstant(*csr_view),
+           ComputeExactCheegerConstant(g.get()));
+}
+
 #define TEST_LIST(F)                                                           \
   F(TestIsRegular_CompleteGraph)                                               \
   F(TestIsRegular_NullGraph)                                                   \
   F(TestIsRegular_CompleteGraphWithSelfLoops)                                  \
   F(TestIsRegular_IrregularGraph)                                              \
+  F(TestComputeDegreeHistogram)                                                \
   F(TestComputeExactCheegerConstant_Ring4)                                     \
   F(TestComputeExactCheegerConstant_K20)                                       \
   F(TestComputeExactCheegerConstant_K20_WithSelfLoops)                         \
@@ -179,6 +376,13 @@ static void TestComputeExactCheegerConstant_AlmostK10() {
   F(TestComputeExactCheegerConstant_K10_Disconnected_1)                        \
   F(TestComputeExactCheegerConstant_K10_Disconnected_2)                        \
   F(TestComputeExactCheegerConstant_AlmostK10)                                 \
+  F(TestComputeExactCheegerConstant_MatchesBruteForce)                         \
+  F(TestComputeExactCheegerConstant_Ring24_Parallel)                           \
+  F(TestComputeExactCheegerCut_MatchesExhaustiveSearch)                        \
+  F(TestComputeExactCheegerCut_ReplacementProduct)                             \
+  F(TestCheegerConstantUpperBound)                                             \
+  F(TestCertifyCheegerLowerBound)                                              \
+  F(TestStaticAndVirtualViewsAgree)                                            \
   (void)0;
 
 DEFINE_MAIN(TEST_LIST)
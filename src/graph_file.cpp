@@ -0,0 +1,215 @@
+#include "graph_file.hpp"
+
+#include "csr_graph.hpp"
+#include "graph_view.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kb {
+namespace {
+static_assert(sizeof(size_t) == sizeof(uint64_t),
+              "Graph files store offsets as 64 bit integers");
+
+template <typename T>
+void WriteArray(std::ofstream &out, std::span<const T> values) {
+  out.write(reinterpret_cast<const char *>(values.data()),
+            values.size_bytes());
+}
+
+// Owns a read-only mapping of a whole graph file.
+class FileMapping {
+public:
+  FileMapping(void *address, size_t size) : address_(address), size_(size) {}
+  ~FileMapping() { munmap(address_, size_); }
+
+  FileMapping(const FileMapping &) = delete;
+  FileMapping &operator=(const FileMapping &) = delete;
+
+  const char *GetData() const { return static_cast<const char *>(address_); }
+
+private:
+  void *address_;
+  size_t size_;
+};
+
+template <typename IndexTy>
+class MappedGraph final : public detail::CsrGraph<IndexTy> {
+public:
+  MappedGraph(std::shared_ptr<const FileMapping> mapping,
+              CsrGraphView<IndexTy> view, bool sorted)
+      : mapping_(std::move(mapping)), sorted_(sorted) {
+    this->SetView(view, sorted);
+  }
+
+  std::unique_ptr<Graph> Clone() override {
+    return std::make_unique<MappedGraph>(mapping_, this->GetView(), sorted_);
+  }
+
+private:
+  std::shared_ptr<const FileMapping> mapping_;
+  bool sorted_;
+};
+
+template <typename IndexTy>
+void WriteGraph(std::ofstream &out, Graph::OrderTy order,
+                std::span<const size_t> offsets,
+                std::span<const IndexTy> neighbors) {
+  GraphFileHeader header;
+  std::memcpy(header.magic, GraphFileHeader::kMagic, sizeof(header.magic));
+  header.version = GraphFileHeader::kCurrentVersion;
+  header.vertex_width = sizeof(IndexTy);
+  header.order = order;
+  header.neighbor_count = neighbors.size();
+  header.flags = 0;
+  bool sorted = true;
+  for (Graph::VertexTy v = 0; v != order && sorted; v++)
+    sorted = std::is_sorted(neighbors.begin() + offsets[v],
+                            neighbors.begin() + offsets[v + 1]);
+  if (sorted)
+    header.flags |= GraphFileHeader::kSortedNeighbors;
+
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  WriteArray(out, offsets);
+  WriteArray(out, neighbors);
+}
+
+// Graphs without CSR storage are flattened one adjacency list at a time.
+template <typename IndexTy>
+void FlattenAndWriteGraph(std::ofstream &out, Graph *g) {
+  std::vector<size_t> offsets;
+  std::vector<IndexTy> neighbors;
+  std::vector<Graph::VertexTy> scratch;
+  offsets.push_back(0);
+  for (Graph::VertexTy v = 0, e = g->GetOrder(); v != e; v++) {
+    auto adjacency = g->GetNeighbors(v, &scratch);
+    neighbors.insert(neighbors.end(), adjacency.begin(), adjacency.end());
+    offsets.push_back(neighbors.size());
+  }
+  WriteGraph<IndexTy>(out, g->GetOrder(), offsets, neighbors);
+}
+
+template <typename IndexTy>
+GraphOrError MapGraph(std::shared_ptr<const FileMapping> mapping,
+                      const GraphFileHeader &header, const std::string &path,
+                      const OpenGraphFileOptions &options) {
+  const char *data = mapping->GetData();
+  size_t offsets_begin = sizeof(GraphFileHeader);
+  size_t neighbors_begin =
+      offsets_begin + (header.order + 1) * sizeof(uint64_t);
+
+  std::span<const size_t> offsets(
+      reinterpret_cast<const size_t *>(data + offsets_begin),
+      header.order + 1);
+  std::span<const IndexTy> neighbors(
+      reinterpret_cast<const IndexTy *>(data + neighbors_begin),
+      header.neighbor_count);
+  if (offsets.front() != 0 || offsets.back() != header.neighbor_count)
+    return path + " is truncated or corrupt";
+
+  bool sorted = header.flags & GraphFileHeader::kSortedNeighbors;
+  if (options.validate) {
+    for (size_t v = 0; v != header.order; v++) {
+      if (offsets[v] > offsets[v + 1])
+        return path + " has decreasing offsets at vertex " + std::to_string(v);
+      if (sorted && !std::is_sorted(neighbors.begin() + offsets[v],
+                                    neighbors.begin() + offsets[v + 1]))
+        return path + " has unsorted neighbors at vertex " + std::to_string(v);
+    }
+    for (IndexTy n : neighbors)
+      if (n >= header.order)
+        return path + " has neighbor " + std::to_string(n) +
+               " out of range for order " + std::to_string(header.order);
+  }
+
+  return std::make_unique<MappedGraph<IndexTy>>(
+      std::move(mapping), CsrGraphView<IndexTy>(offsets, neighbors), sorted);
+}
+} // namespace
+
+std::optional<std::string> WriteGraphFile(Graph *g, const std::string &path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open())
+    return "Could not open " + path + " for writing";
+
+  if (const auto *view = g->GetCompactCsrView())
+    WriteGraph(out, g->GetOrder(), view->GetOffsets(),
+               view->GetNeighborArray());
+  else if (const auto *view = g->GetWideCsrView())
+    WriteGraph(out, g->GetOrder(), view->GetOffsets(),
+               view->GetNeighborArray());
+  else if (FitsCompactVertexTy(g->GetOrder()))
+    FlattenAndWriteGraph<CompactVertexTy>(out, g);
+  else
+    FlattenAndWriteGraph<Graph::VertexTy>(out, g);
+
+  if (!out.good())
+    return "Could not write " + path;
+  return std::nullopt;
+}
+
+GraphOrError OpenGraphFile(const std::string &path,
+                           const OpenGraphFileOptions &options) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return "Could not open " + path + ": " + std::strerror(errno);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return "Could not stat " + path + ": " + std::strerror(errno);
+  }
+
+  size_t file_size = st.st_size;
+  if (file_size < sizeof(GraphFileHeader)) {
+    close(fd);
+    return path + " is too small to be a graph file";
+  }
+
+  void *address = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED)
+    return "Could not map " + path + ": " + std::strerror(errno);
+
+  auto mapping = std::make_shared<const FileMapping>(address, file_size);
+  const char *data = mapping->GetData();
+
+  GraphFileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, GraphFileHeader::kMagic, sizeof(header.magic)))
+    return path + " is not a graph file";
+  if (header.version != GraphFileHeader::kCurrentVersion)
+    return path + " has unsupported version " +
+           std::to_string(header.version);
+  if (header.vertex_width != sizeof(CompactVertexTy) &&
+      header.vertex_width != sizeof(Graph::VertexTy))
+    return path + " has unsupported vertex width " +
+           std::to_string(header.vertex_width);
+
+  // Bound each count by the file size before multiplying, so that huge
+  // header fields cannot wrap around to a matching size.
+  size_t offsets_begin = sizeof(GraphFileHeader);
+  if (header.order >= (file_size - offsets_begin) / sizeof(uint64_t))
+    return path + " is truncated or corrupt";
+  size_t neighbors_begin =
+      offsets_begin + (header.order + 1) * sizeof(uint64_t);
+  if (header.neighbor_count >
+          (file_size - neighbors_begin) / header.vertex_width ||
+      file_size !=
+          neighbors_begin + header.neighbor_count * header.vertex_width)
+    return path + " is truncated or corrupt";
+
+  if (header.vertex_width == sizeof(CompactVertexTy))
+    return MapGraph<CompactVertexTy>(std::move(mapping), header, path,
+                                     options);
+  return MapGraph<Graph::VertexTy>(std::move(mapping), header, path, options);
+}
+} // namespace kb
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace kb {
+// Graphs are stored on disk in a versioned, native-endian CSR layout:
+//
+//   GraphFileHeader
+//   uint64_t offsets[order + 1]
+//   neighbors[neighbor_count], each `vertex_width` bytes wide
+//
+// `vertex_width` is 4 for graphs whose vertices fit in a CompactVertexTy and 8
+// otherwise.
+// The neighbors of vertex `v` are neighbors[offsets[v]] to
+// neighbors[offsets[v + 1]].  The 40 byte header keeps both arrays 8 byte
+// aligned, so they can be used in place once the file is mapped.
+struct GraphFileHeader {
+  static constexpr char kMagic[8] = {'K', 'B', 'G', 'R', 'A', 'P', 'H', '\0'};
+  static constexpr unsigned kCurrentVersion = 2;
+
+  // Set in `flags` if every neighbor list is in ascending order.
+  static constexpr uint64_t kSortedNeighbors = 1;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t vertex_width;
+  uint64_t order;
+  uint64_t neighbor_count;
+  uint64_t flags;
+};
+
+static_assert(sizeof(GraphFileHeader) == 40);
+
+struct OpenGraphFileOptions {
+  // Scan the whole file on open: the offsets must be non-decreasing, every
+  // neighbor must be a vertex and, if the header says so, every neighbor list
+  // must be sorted.  This touches every page of the file.
+  bool validate = false;
+};
+
+// Writes `g` to `path`.  Returns an error message on failure.
+std::optional<std::string> WriteGraphFile(Graph *g, const std::string &path);
+
+// Maps the graph file at `path` into memory and returns a read-only graph that
+// serves its adjacency directly from the mapped pages.  Without
+// `options.validate`, opening reads only the header and both ends of the
+// offsets array, so pages are faulted in as the graph is used; a file that is
+// corrupt in between can then yield reads out of bounds.  Whether the graph is
+// undirected is left to CheckConsistency.
+GraphOrError OpenGraphFile(const std::string &path,
+                           const OpenGraphFileOptions &options = {});
+} // namespace kb
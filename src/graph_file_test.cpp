@@ -0,0 +1,180 @@
+#include "graph_file.hpp"
+
+#include "graph_zoo.hpp"
+#include "test.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace kb;
+
+static std::string GetTemporaryPath(const std::string &name) {
+  return (std::filesystem::temp_directory_path() /
+          (name + "." + std::to_string(getpid()) + ".kbgraph"))
+      .string();
+}
+
+static std::unique_ptr<Graph> RoundTrip(Graph *g, const std::string &path) {
+  if (WriteGraphFile(g, path).has_value())
+    return nullptr;
+  auto result = OpenGraphFile(path);
+  if (auto *error = std::get_if<std::string>(&result)) {
+    std::cerr << *error << std::endl;
+    return nullptr;
+  }
+  return std::move(std::get<std::unique_ptr<Graph>>(result));
+}
+
+static void TestRoundTrip_ConcreteGraph() {
+  std::string path = GetTemporaryPath("concrete");
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 2}, {0, 4}, {1, 3}, {2, 4},
+  };
+  std::unique_ptr<Graph> original = CreateConcreteGraph(6, edges);
+  std::unique_ptr<Graph> mapped = RoundTrip(original.get(), path);
+  CHECK(mapped != nullptr);
+
+  CHECK_EQ(mapped->GetOrder(), 6);
+  CHECK(mapped->GetCompactCsrView() != nullptr);
+  CHECK(!CheckConsistency(mapped.get()).has_value());
+  CHECK_EDGES_EQ(edges, mapped);
+
+  // Clones share the mapping and outlive the original handle.
+  std::unique_ptr<Graph> clone = mapped->Clone();
+  mapped.reset();
+  CHECK_EDGES_EQ(edges, clone);
+
+  std::filesystem::remove(path);
+}
+
+static void TestRoundTrip_ReplacementProduct() {
+  std::string path = GetTemporaryPath("product");
+  auto product = CreateReplacementProduct(CreateRingGraph(5),
+                                          CreateCompleteGraph(2, false));
+  std::unique_ptr<Graph> mapped = RoundTrip(product.get(), path);
+  CHECK(mapped != nullptr);
+
+  std::vector<Graph::EdgeTy> expected_edges;
+  for (auto e : Iterate(product->GetEdges()))
+    expected_edges.push_back(e);
+
+  CHECK_EQ(mapped->GetOrder(), 10);
+  CHECK(!CheckConsistency(mapped.get()).has_value());
+  CHECK_EDGES_EQ(expected_edges, mapped);
+
+  std::filesystem::remove(path);
+}
+
+static uint64_t ReadFlags(const std::string &path) {
+  GraphFileHeader header;
+  std::ifstream in(path, std::ios::binary);
+  in.read(reinterpret_cast<char *>(&header), sizeof(header));
+  return header.flags;
+}
+
+static void TestWriteGraphFile_RecordsSortedness() {
+  std::string path = GetTemporaryPath("sorted");
+  auto graph = CreateCompleteGraph(5, false);
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  CHECK(ReadFlags(path) & GraphFileHeader::kSortedNeighbors);
+
+  // Mapped graphs that keep the flag write it back out.
+  std::unique_ptr<Graph> mapped = RoundTrip(graph.get(), path);
+  CHECK(mapped != nullptr);
+  std::string copy_path = GetTemporaryPath("sorted_copy");
+  CHECK(!WriteGraphFile(mapped.get(), copy_path).has_value());
+  CHECK(ReadFlags(copy_path) & GraphFileHeader::kSortedNeighbors);
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(copy_path);
+}
+
+static void TestOpenGraphFile_Errors() {
+  CHECK(std::holds_alternative<std::string>(
+      OpenGraphFile(GetTemporaryPath("does_not_exist"))));
+
+  std::string path = GetTemporaryPath("garbage");
+  {
+    std::ofstream out(path);
+    out << "this is not a graph file, but it is long enough to have a header";
+  }
+  CHECK(std::holds_alternative<std::string>(OpenGraphFile(path)));
+
+  auto graph = CreateCompleteGraph(4, false);
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  CHECK(std::holds_alternative<std::string>(OpenGraphFile(path)));
+
+  std::filesystem::remove(path);
+}
+
+// Overwrites `size` bytes at `offset` of the file at `path`.
+static void Patch(const std::string &path, size_t offset, const void *bytes,
+                  size_t size) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(offset);
+  file.write(static_cast<const char *>(bytes), size);
+}
+
+static void TestOpenGraphFile_CorruptContents() {
+  std::string path = GetTemporaryPath("corrupt");
+  auto graph = CreateCompleteGraph(4, false);
+  size_t offsets_begin = sizeof(GraphFileHeader);
+  size_t neighbors_begin = offsets_begin + 5 * sizeof(uint64_t);
+  auto is_invalid = [&] {
+    return std::holds_alternative<std::string>(
+        OpenGraphFile(path, {.validate = true}));
+  };
+
+  // Offsets 0, 3, 1, 9, 12.  Only a validating open reads the middle.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  uint64_t offset = 1;
+  Patch(path, offsets_begin + 2 * sizeof(uint64_t), &offset, sizeof(offset));
+  CHECK(std::holds_alternative<std::unique_ptr<Graph>>(OpenGraphFile(path)));
+  CHECK(is_invalid());
+
+  // Offsets past the end.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  offset = 100;
+  Patch(path, offsets_begin + 3 * sizeof(uint64_t), &offset, sizeof(offset));
+  CHECK(is_invalid());
+
+  // The last offset disagrees with the neighbor count.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  offset = 11;
+  Patch(path, offsets_begin + 4 * sizeof(uint64_t), &offset, sizeof(offset));
+  CHECK(std::holds_alternative<std::string>(OpenGraphFile(path)));
+
+  // A neighbor that is not a vertex.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  CompactVertexTy neighbor = 4;
+  Patch(path, neighbors_begin, &neighbor, sizeof(neighbor));
+  CHECK(is_invalid());
+
+  // Neighbors 3, 2, 3 of vertex 0 in a file that claims sorted lists.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  neighbor = 3;
+  Patch(path, neighbors_begin, &neighbor, sizeof(neighbor));
+  CHECK(is_invalid());
+
+  // Counts whose byte sizes wrap around to the file size.
+  CHECK(!WriteGraphFile(graph.get(), path).has_value());
+  uint64_t neighbor_count = (uint64_t(1) << 62) + 12;
+  Patch(path, offsetof(GraphFileHeader, neighbor_count), &neighbor_count,
+        sizeof(neighbor_count));
+  CHECK(std::holds_alternative<std::string>(OpenGraphFile(path)));
+
+  std::filesystem::remove(path);
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestRoundTrip_ConcreteGraph)                                               \
+  F(TestRoundTrip_ReplacementProduct)                                          \
+  F(TestWriteGraphFile_RecordsSortedness)                                      \
+  F(TestOpenGraphFile_Errors)                                                  \
+  F(TestOpenGraphFile_CorruptContents)                                         \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,454 @@
+#include "graph_import.hpp"
+
+#include "graph_view.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace kb {
+namespace {
+// Where the edges start in a file, and the order if the file states it.
+struct FileLayout {
+  long data_begin = 0;
+  std::optional<Graph::OrderTy> order;
+};
+
+using FileCloser = decltype([](FILE *f) { std::fclose(f); });
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char *SkipBlanks(const char *p, const char *end) {
+  while (p != end && IsBlank(*p))
+    p++;
+  return p;
+}
+
+// Parses a decimal integer at `*p`, advancing `*p` past it.  Returns false if
+// there are no digits at `*p` or the value does not fit in a VertexTy.
+bool ParseUnsigned(const char **p, const char *end, Graph::VertexTy *out) {
+  constexpr Graph::VertexTy kMax = std::numeric_limits<Graph::VertexTy>::max();
+  const char *it = *p;
+  Graph::VertexTy value = 0;
+  for (; it != end && *it >= '0' && *it <= '9'; it++) {
+    Graph::VertexTy digit = *it - '0';
+    if (value > (kMax - digit) / 10)
+      return false;
+    value = value * 10 + digit;
+  }
+  if (it == *p)
+    return false;
+  *p = it;
+  *out = value;
+  return true;
+}
+
+// Reads lines from the current position of `f` until `fn` returns true for
+// one of them.  Returns false if the file ends first.
+template <typename Fn> bool ReadHeaderLines(FILE *f, Fn fn) {
+  std::string line;
+  for (int c = std::fgetc(f); c != EOF; c = std::fgetc(f)) {
+    line.push_back(c);
+    if (c != '\n')
+      continue;
+    if (fn(line))
+      return true;
+    line.clear();
+  }
+  return !line.empty() && fn(line);
+}
+
+std::variant<FileLayout, std::string>
+ReadLayout(FILE *f, const std::string &path, EdgeListFormat format) {
+  FileLayout layout;
+  switch (format) {
+  case EdgeListFormat::kEdgeList: {
+    // An optional "# order <n>" first line, as written by ExportGraph, states
+    // the order.  The parser skips it like any other comment.
+    bool malformed = false;
+    std::string first_line;
+    ReadHeaderLines(f, [&](const std::string &line) {
+      first_line = line;
+      const char *p = line.data();
+      const char *end = p + line.size();
+      if (!line.starts_with("# order") || (p + 7 != end && !IsBlank(p[7])))
+        return true;
+      p = SkipBlanks(p + 7, end);
+      Graph::VertexTy order;
+      malformed = !ParseUnsigned(&p, end, &order);
+      p = SkipBlanks(p, end);
+      malformed |= p != end && !(*p == '\n' && p + 1 == end);
+      if (!malformed)
+        layout.order = order;
+      return true;
+    });
+    if (malformed) {
+      while (!first_line.empty() &&
+             (first_line.back() == '\n' || IsBlank(first_line.back())))
+        first_line.pop_back();
+      return "Malformed order line \"" + first_line + "\" in " + path;
+    }
+    return layout;
+  }
+
+  case EdgeListFormat::kMatrixMarket: {
+    bool first_line = true;
+    bool is_coordinate = false;
+    bool found = ReadHeaderLines(f, [&](const std::string &line) {
+      if (first_line) {
+        first_line = false;
+        is_coordinate = line.starts_with("%%MatrixMarket") &&
+                        line.find("coordinate") != std::string::npos;
+        return !is_coordinate;
+      }
+      if (line.starts_with("%"))
+        return false;
+
+      unsigned long rows, columns, entries;
+      if (std::sscanf(line.c_str(), "%lu %lu %lu", &rows, &columns,
+                      &entries) == 3)
+        layout.order = std::max(rows, columns);
+      return true;
+    });
+    if (!found || !is_coordinate || !layout.order)
+      return path + " is not a Matrix Market coordinate file";
+    layout.data_begin = std::ftell(f);
+    return layout;
+  }
+
+  case EdgeListFormat::kDimacs: {
+    bool found = ReadHeaderLines(f, [&](const std::string &line) {
+      unsigned long order, edges;
+      char kind[16];
+      if (std::sscanf(line.c_str(), "p %15s %lu %lu", kind, &order, &edges) ==
+          3)
+        layout.order = order;
+      return layout.order.has_value();
+    });
+    if (!found)
+      return path + " has no DIMACS problem line";
+    layout.data_begin = std::ftell(f);
+    return layout;
+  }
+  }
+
+  assert(false && "Unknown format");
+  return layout;
+}
+
+// Streams the edges of a file in chunks, parsing each chunk with several
+// threads.  `fn(task, a, b)` is called concurrently with 0-based endpoints;
+// calls with the same `task` never overlap.  The number of tasks is at most
+// GetDefaultConcurrency().
+class EdgeStreamer {
+public:
+  EdgeStreamer(const std::string &path, EdgeListFormat format,
+               const FileLayout &layout, const ImportOptions &options)
+      : path_(path), format_(format), layout_(layout),
+        chunk_size_(std::max<size_t>(options.chunk_size, 1)),
+        max_order_(options.max_order) {}
+
+  template <typename Fn> std::optional<std::string> ForEachEdge(Fn fn) {
+    FilePtr f(std::fopen(path_.c_str(), "rb"));
+    if (!f)
+      return "Could not open " + path_ + ": " + std::strerror(errno);
+    if (std::fseek(f.get(), layout_.data_begin, SEEK_SET) != 0)
+      return "Could not seek in " + path_;
+
+    error_.reset();
+    failed_ = false;
+
+    // `buffer` holds the unparsed tail of the previous chunk followed by the
+    // next chunk of the file.  Only whole lines are parsed, and the trailing
+    // partial line is carried over to the next iteration.
+    std::vector<char> buffer;
+    size_t carried = 0;
+    bool at_eof = false;
+    while (!at_eof && !failed_) {
+      buffer.resize(carried + chunk_size_);
+      size_t read =
+          std::fread(buffer.data() + carried, 1, chunk_size_, f.get());
+      if (std::ferror(f.get()))
+        return "Could not read " + path_;
+      at_eof = read < chunk_size_;
+
+      size_t size = carried + read;
+      size_t parse_end = size;
+      if (!at_eof) {
+        while (parse_end != 0 && buffer[parse_end - 1] != '\n')
+          parse_end--;
+        if (parse_end == 0) {
+          // A single line longer than the chunk; keep reading.
+          carried = size;
+          continue;
+        }
+      }
+
+      ParseChunk(buffer.data(), parse_end, fn);
+
+      carried = size - parse_end;
+      std::copy(buffer.begin() + parse_end, buffer.begin() + size,
+                buffer.begin());
+    }
+
+    return error_;
+  }
+
+private:
+  // Chunks smaller than this are parsed on a single thread.
+  static constexpr size_t kParseGrain = 1 << 20;
+
+  template <typename Fn>
+  void ParseChunk(const char *data, size_t size, Fn &fn) {
+    unsigned tasks = GetTaskCount(size, kParseGrain);
+    ParallelFor(size, tasks, [&](unsigned task, size_t begin, size_t end) {
+      // Every task parses the lines that start in [begin, end).
+      const char *p = data + begin;
+      if (begin != 0) {
+        while (p != data + size && p[-1] != '\n')
+          p++;
+      }
+
+      const char *chunk_end = data + size;
+      while (p < data + end && !failed_) {
+        const char *line_end =
+            static_cast<const char *>(std::memchr(p, '\n', chunk_end - p));
+        if (!line_end)
+          line_end = chunk_end;
+        ParseLine(task, p, line_end, fn);
+        p = line_end + 1;
+      }
+    });
+  }
+
+  template <typename Fn>
+  void ParseLine(unsigned task, const char *p, const char *end, Fn &fn) {
+    p = SkipBlanks(p, end);
+    if (p == end)
+      return;
+
+    const char *line = p;
+
+    switch (format_) {
+    case EdgeListFormat::kEdgeList:
+      if (*p == '#' || *p == '%')
+        return;
+      break;
+    case EdgeListFormat::kMatrixMarket:
+      if (*p == '%')
+        return;
+      break;
+    case EdgeListFormat::kDimacs:
+      if (*p != 'e')
+        return;
+      p = SkipBlanks(p + 1, end);
+      break;
+    }
+
+    Graph::VertexTy a, b;
+    bool ok = ParseUnsigned(&p, end, &a);
+    if (ok) {
+      p = SkipBlanks(p, end);
+      ok = ParseUnsigned(&p, end, &b);
+    }
+    if (!ok) {
+      ReportError("Malformed line \"" + std::string(line, end) + "\" in " +
+                  path_);
+      return;
+    }
+
+    if (format_ != EdgeListFormat::kEdgeList) {
+      if (a == 0 || b == 0) {
+        ReportError("Vertex ids in " + path_ + " must be 1-based");
+        return;
+      }
+      a--;
+      b--;
+    }
+
+    if (std::max(a, b) >= max_order_) {
+      ReportError("Vertex id in line \"" + std::string(line, end) + "\" of " +
+                  path_ + " is not below the maximum order " +
+                  std::to_string(max_order_));
+      return;
+    }
+    if (layout_.order && (a >= *layout_.order || b >= *layout_.order)) {
+      ReportError("Edge (" + std::to_string(a) + ", " + std::to_string(b) +
+                  ") in " + path_ + " is out of range for order " +
+                  std::to_string(*layout_.order));
+      return;
+    }
+
+    fn(task, a, b);
+  }
+
+  void ReportError(std::string error) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (!error_)
+      error_ = std::move(error);
+    failed_ = true;
+  }
+
+  std::string path_;
+  EdgeListFormat format_;
+  FileLayout layout_;
+  size_t chunk_size_;
+  Graph::OrderTy max_order_;
+
+  std::mutex error_mutex_;
+  std::optional<std::string> error_;
+  std::atomic<bool> failed_ = false;
+};
+
+size_t AtomicIncrement(size_t &counter) {
+  return std::atomic_ref<size_t>(counter).fetch_add(1,
+                                                    std::memory_order_relaxed);
+}
+
+// Streams the edges a second time, placing both directions of every edge at
+// the slots reserved for them by the degree counts in `offsets`.
+template <typename IndexTy>
+GraphOrError ScatterEdges(const std::string &path, EdgeStreamer *streamer,
+                          std::vector<size_t> offsets) {
+  std::vector<IndexTy> neighbors(offsets.back());
+  std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+  std::atomic<bool> overflowed = false;
+  auto place = [&](Graph::VertexTy from, Graph::VertexTy to) {
+    size_t slot = AtomicIncrement(cursors[from]);
+    if (slot < offsets[from + 1])
+      neighbors[slot] = static_cast<IndexTy>(to);
+    else
+      overflowed = true;
+  };
+  auto error = streamer->ForEachEdge(
+      [&](unsigned, Graph::VertexTy a, Graph::VertexTy b) {
+        place(a, b);
+        if (a != b)
+          place(b, a);
+      });
+  if (error)
+    return *error;
+  if (overflowed)
+    return path + " changed while it was being imported";
+
+  return CreateConcreteGraphFromAdjacency(std::move(offsets),
+                                          std::move(neighbors));
+}
+} // namespace
+
+GraphOrError ImportGraph(const std::string &path, EdgeListFormat format,
+                         const ImportOptions &options) {
+  FileLayout layout;
+  {
+    FilePtr f(std::fopen(path.c_str(), "rb"));
+    if (!f)
+      return "Could not open " + path + ": " + std::strerror(errno);
+    auto maybe_layout = ReadLayout(f.get(), path, format);
+    if (auto *error = std::get_if<std::string>(&maybe_layout))
+      return *error;
+    layout = std::get<FileLayout>(maybe_layout);
+  }
+  if (layout.order && *layout.order > options.max_order)
+    return path + " states order " + std::to_string(*layout.order) +
+           ", above the maximum order " + std::to_string(options.max_order);
+
+  if (!layout.order) {
+    std::vector<Graph::VertexTy> max_vertex(GetDefaultConcurrency(), 0);
+    std::vector<char> any_edge(GetDefaultConcurrency(), false);
+    EdgeStreamer streamer(path, format, layout, options);
+    auto error = streamer.ForEachEdge(
+        [&](unsigned task, Graph::VertexTy a, Graph::VertexTy b) {
+          max_vertex[task] = std::max({max_vertex[task], a, b});
+          any_edge[task] = true;
+        });
+    if (error)
+      return *error;
+
+    layout.order = 0;
+    for (unsigned i = 0; i < max_vertex.size(); i++)
+      if (any_edge[i])
+        layout.order = std::max(*layout.order, max_vertex[i] + 1);
+  }
+
+  Graph::OrderTy order = *layout.order;
+  EdgeStreamer streamer(path, format, layout, options);
+
+  // Count degrees into offsets[v + 1], exactly like CreateConcreteGraph ...
+  std::vector<size_t> offsets(order + 1, 0);
+  auto error = streamer.ForEachEdge(
+      [&](unsigned, Graph::VertexTy a, Graph::VertexTy b) {
+        AtomicIncrement(offsets[a + 1]);
+        if (a != b)
+          AtomicIncrement(offsets[b + 1]);
+      });
+  if (error)
+    return *error;
+
+  for (Graph::OrderTy v = 0; v < order; v++)
+    offsets[v + 1] += offsets[v];
+
+  if (FitsCompactVertexTy(order))
+    return ScatterEdges<CompactVertexTy>(path, &streamer, std::move(offsets));
+  return ScatterEdges<Graph::VertexTy>(path, &streamer, std::move(offsets));
+}
+
+std::optional<std::string> ExportGraph(Graph *g, const std::string &path,
+                                       EdgeListFormat format) {
+  FilePtr f(std::fopen(path.c_str(), "wb"));
+  if (!f)
+    return "Could not open " + path + " for writing: " + std::strerror(errno);
+
+  Graph::OrderTy order = g->GetOrder();
+  if (format == EdgeListFormat::kEdgeList) {
+    // Without it, isolated vertices after the largest endpoint would be lost.
+    std::fprintf(f.get(), "# order %lu\n", order);
+  } else {
+    size_t edge_count = 0;
+    ForEachEdgeChunk(g, [&](std::span<const Graph::EdgeTy> edges) {
+      edge_count += edges.size();
+    });
+
+    if (format == EdgeListFormat::kMatrixMarket)
+      std::fprintf(f.get(),
+                   "%%%%MatrixMarket matrix coordinate pattern symmetric\n"
+                   "%lu %lu %zu\n",
+                   order, order, edge_count);
+    else
+      std::fprintf(f.get(), "p edge %lu %zu\n", order, edge_count);
+  }
+
+  // Matrix Market and DIMACS ids are 1-based, and symmetric Matrix Market
+  // entries belong to the lower triangle.
+  Graph::VertexTy id_base = format == EdgeListFormat::kEdgeList ? 0 : 1;
+  const char *line_prefix = format == EdgeListFormat::kDimacs ? "e " : "";
+  bool swap = format == EdgeListFormat::kMatrixMarket;
+
+  std::string buffer;
+  ForEachEdgeChunk(g, [&](std::span<const Graph::EdgeTy> edges) {
+    buffer.clear();
+    char line[64];
+    for (auto [a, b] : edges) {
+      if (swap)
+        std::swap(a, b);
+      int length = std::snprintf(line, sizeof(line), "%s%lu %lu\n",
+                                 line_prefix, a + id_base, b + id_base);
+      buffer.append(line, length);
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), f.get());
+  });
+
+  if (std::ferror(f.get()) || std::fclose(f.release()) != 0)
+    return "Could not write " + path;
+  return std::nullopt;
+}
+} // namespace kb
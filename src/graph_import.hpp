@@ -0,0 +1,51 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace kb {
+enum class EdgeListFormat {
+  // One "<u> <v>" pair of 0-based vertex ids per line.  Anything after the
+  // second id (e.g. a weight) is ignored, as are lines starting with '#' or
+  // '%'.  The order is stated by a "# order <n>" first line if there is one,
+  // and is otherwise one more than the largest id seen.  A first line with
+  // the words "# order" and anything but a number after them is an error.
+  kEdgeList,
+
+  // A Matrix Market "coordinate" file.  Entries are 1-based and values, if
+  // any, are ignored.  The order is the larger of the two matrix dimensions.
+  kMatrixMarket,
+
+  // A DIMACS graph file: a "p edge <order> <edges>" problem line followed by
+  // 1-based "e <u> <v>" lines.
+  kDimacs,
+};
+
+struct ImportOptions {
+  // The file is streamed through a buffer of roughly this many bytes, and
+  // each buffer is parsed by several threads in parallel.
+  size_t chunk_size = 64 << 20;
+
+  // Files with a vertex id at or above this, or stating a larger order, are
+  // rejected, so that one stray id cannot make the importer allocate offsets
+  // for billions of vertices.  Raise it for larger graphs.
+  Graph::OrderTy max_order = Graph::OrderTy(1) << 32;
+};
+
+// Reads an undirected graph from a text file.  The file is streamed twice (or
+// three times for a kEdgeList file that does not state its order): once
+// to count degrees and once to scatter the edges straight into CSR storage, so
+// the whole edge list is never held in memory.
+GraphOrError ImportGraph(const std::string &path, EdgeListFormat format,
+                         const ImportOptions &options = {});
+
+// Writes every edge of `g` once to a text file that ImportGraph reads back.
+// Matrix Market files are written as symmetric patterns, and edge lists start
+// with a "# order <n>" line so that trailing isolated vertices survive the
+// round trip.  Returns an error message on failure.
+std::optional<std::string> ExportGraph(Graph *g, const std::string &path,
+                                       EdgeListFormat format);
+} // namespace kb
@@ -0,0 +1,207 @@
+#include "graph_import.hpp"
+
+#include "parallel.hpp"
+#include "test.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <unistd.h>
+
+using namespace kb;
+
+static std::string WriteTemporaryFile(const std::string &name,
+                                      const std::string &contents) {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      (name + "." + std::to_string(getpid()) + ".txt"))
+                         .string();
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  return path;
+}
+
+static std::unique_ptr<Graph> ImportOrNull(const std::string &path,
+                                           EdgeListFormat format,
+                                           const ImportOptions &options = {}) {
+  auto result = ImportGraph(path, format, options);
+  std::filesystem::remove(path);
+  if (auto *error = std::get_if<std::string>(&result)) {
+    std::cerr << *error << std::endl;
+    return nullptr;
+  }
+  return std::move(std::get<std::unique_ptr<Graph>>(result));
+}
+
+static void TestImportGraph_EdgeList() {
+  std::string path = WriteTemporaryFile("edge_list", "# A comment\n"
+                                                     "0 1\n"
+                                                     "  1\t2 0.5\n"
+                                                     "\n"
+                                                     "2 0\r\n"
+                                                     "0 1\n"
+                                                     "4 4");
+  auto g = ImportOrNull(path, EdgeListFormat::kEdgeList);
+  CHECK(g != nullptr);
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 1}, {1, 2}, {0, 2}, {4, 4}};
+  CHECK_EQ(g->GetOrder(), 5);
+  CHECK(!CheckConsistency(g.get()).has_value());
+  CHECK_EDGES_EQ(expected_edges, g);
+}
+
+static void TestImportGraph_MatrixMarket() {
+  std::string path =
+      WriteTemporaryFile("matrix_market", "%%MatrixMarket matrix coordinate "
+                                          "pattern symmetric\n"
+                                          "% A comment\n"
+                                          "6 6 3\n"
+                                          "2 1\n"
+                                          "3 1\n"
+                                          "6 5\n");
+  auto g = ImportOrNull(path, EdgeListFormat::kMatrixMarket);
+  CHECK(g != nullptr);
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 1}, {0, 2}, {4, 5}};
+  CHECK_EQ(g->GetOrder(), 6);
+  CHECK_EDGES_EQ(expected_edges, g);
+}
+
+static void TestImportGraph_Dimacs() {
+  std::string path = WriteTemporaryFile("dimacs", "c A comment\n"
+                                                  "p edge 4 3\n"
+                                                  "e 1 2\n"
+                                                  "e 2 3\n"
+                                                  "e 3 4\n");
+  auto g = ImportOrNull(path, EdgeListFormat::kDimacs);
+  CHECK(g != nullptr);
+
+  std::vector<Graph::EdgeTy> expected_edges = {{0, 1}, {1, 2}, {2, 3}};
+  CHECK_EQ(g->GetOrder(), 4);
+  CHECK_EDGES_EQ(expected_edges, g);
+}
+
+static void TestImportGraph_SmallChunksManyThreads() {
+  // A large file streamed through a tiny buffer, so that lines straddle chunk
+  // boundaries, with enough data per chunk to be parsed by several threads.
+  const Graph::OrderTy order = 200000;
+  std::string contents;
+  std::set<Graph::EdgeTy> expected_edge_set;
+  for (Graph::VertexTy i = 0; i < order; i++) {
+    for (Graph::VertexTy step : {1, 17, 4242}) {
+      Graph::VertexTy j = (i * step + 11) % order;
+      contents += std::to_string(i) + " " + std::to_string(j) + "\n";
+      expected_edge_set.insert({std::min(i, j), std::max(i, j)});
+    }
+  }
+
+  std::string path = WriteTemporaryFile("large", contents);
+  ImportOptions options;
+  options.chunk_size = (3 << 20) + 7;
+  SetDefaultConcurrency(4);
+  auto g = ImportOrNull(path, EdgeListFormat::kEdgeList, options);
+  SetDefaultConcurrency(0);
+  CHECK(g != nullptr);
+
+  std::vector<Graph::EdgeTy> expected_edges(expected_edge_set.begin(),
+                                            expected_edge_set.end());
+  CHECK_EQ(g->GetOrder(), order);
+  CHECK(!CheckConsistency(g.get()).has_value());
+  CHECK_EDGES_EQ(expected_edges, g);
+}
+
+static void TestImportGraph_Errors() {
+  auto is_error = [](const std::string &path, EdgeListFormat format,
+                     const ImportOptions &options = {}) {
+    bool result = std::holds_alternative<std::string>(
+        ImportGraph(path, format, options));
+    std::filesystem::remove(path);
+    return result;
+  };
+
+  CHECK(is_error("/does/not/exist", EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("malformed", "0 1\n0 x\n"),
+                 EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("out_of_range", "p edge 2 1\ne 1 3\n"),
+                 EdgeListFormat::kDimacs));
+  CHECK(is_error(WriteTemporaryFile("zero_based", "p edge 2 1\ne 0 1\n"),
+                 EdgeListFormat::kDimacs));
+  CHECK(is_error(WriteTemporaryFile("no_header", "1 2\n"),
+                 EdgeListFormat::kMatrixMarket));
+  CHECK(is_error(WriteTemporaryFile("above_order", "# order 3\n0 3\n"),
+                 EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("bad_order", "# order ten\n0 1\n"),
+                 EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("bad_order", "# order 10 11\n0 1\n"),
+                 EdgeListFormat::kEdgeList));
+
+  // Ids that wrap around or exceed the maximum order would otherwise size the
+  // graph.
+  CHECK(is_error(WriteTemporaryFile("overflow", "0 18446744073709551617\n"),
+                 EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("huge_id", "0 1\n0 4294967296\n"),
+                 EdgeListFormat::kEdgeList));
+  CHECK(is_error(WriteTemporaryFile("huge_order", "p edge 4294967297 0\n"),
+                 EdgeListFormat::kDimacs));
+  CHECK(is_error(WriteTemporaryFile("above_max", "0 1\n2 10\n"),
+                 EdgeListFormat::kEdgeList, {.max_order = 10}));
+  CHECK(!is_error(WriteTemporaryFile("below_max", "0 1\n2 9\n"),
+                  EdgeListFormat::kEdgeList, {.max_order = 10}));
+}
+
+static void TestImportGraph_StatedOrder() {
+  // Trailing blanks and CRLF line endings are allowed after the order.
+  for (const char *header : {"# order 6\n", "# order 6 \r\n", "# order\t6"}) {
+    auto g = ImportOrNull(
+        WriteTemporaryFile("stated_order", std::string(header) + "\n0 1\n"),
+        EdgeListFormat::kEdgeList);
+    CHECK(g != nullptr);
+    CHECK_EQ(g->GetOrder(), 6);
+  }
+
+  // Other comments on the first line are not headers.
+  auto g = ImportOrNull(WriteTemporaryFile("ordering", "# ordering\n0 1\n"),
+                        EdgeListFormat::kEdgeList);
+  CHECK(g != nullptr);
+  CHECK_EQ(g->GetOrder(), 2);
+}
+
+static void TestExportGraph_RoundTrip() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {3, 1}, {2, 2}, {0, 5}, {4, 5}};
+  std::unique_ptr<Graph> original = CreateConcreteGraph(6, edges);
+
+  for (EdgeListFormat format :
+       {EdgeListFormat::kEdgeList, EdgeListFormat::kMatrixMarket,
+        EdgeListFormat::kDimacs}) {
+    std::string path = WriteTemporaryFile("export", "");
+    CHECK(!ExportGraph(original.get(), path, format).has_value());
+    auto g = ImportOrNull(path, format);
+    CHECK(g != nullptr);
+    CHECK_EQ(g->GetOrder(), 6);
+    CHECK_EDGES_EQ(edges, g);
+  }
+}
+
+static void TestExportGraph_TrailingIsolatedVertices() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}};
+  std::unique_ptr<Graph> original = CreateConcreteGraph(5, edges);
+  std::string path = WriteTemporaryFile("export_isolated", "");
+  CHECK(!ExportGraph(original.get(), path, EdgeListFormat::kEdgeList)
+             .has_value());
+  auto g = ImportOrNull(path, EdgeListFormat::kEdgeList);
+  CHECK(g != nullptr);
+  CHECK_EQ(g->GetOrder(), 5);
+  CHECK_EDGES_EQ(edges, g);
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestImportGraph_EdgeList)                                                  \
+  F(TestImportGraph_MatrixMarket)                                              \
+  F(TestImportGraph_Dimacs)                                                    \
+  F(TestImportGraph_SmallChunksManyThreads)                                    \
+  F(TestImportGraph_Errors)                                                    \
+  F(TestImportGraph_StatedOrder)                                               \
+  F(TestExportGraph_RoundTrip)                                                 \
+  F(TestExportGraph_TrailingIsolatedVertices)                                  \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,285 @@
+#include "graph_reorder.hpp"
+
+#include "graph_view.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace kb {
+namespace {
+// Below this many adjacency entries per task relabeling is not worth
+// spreading over multiple threads.
+constexpr size_t kRelabelGrain = 1 << 16;
+
+std::vector<Graph::VertexTy>
+InvertPermutation(const std::vector<Graph::VertexTy> &permutation) {
+  std::vector<Graph::VertexTy> inverse(permutation.size());
+  for (Graph::VertexTy v = 0, e = permutation.size(); v != e; v++)
+    inverse[permutation[v]] = v;
+  return inverse;
+}
+
+// Each of the functions below returns the vertices in their new order, that
+// is the inverse permutation.
+
+template <GraphView G>
+std::vector<Graph::VertexTy> ComputeDegreeSortOrder(const G &g) {
+  std::vector<Graph::VertexTy> order(g.GetOrder());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](Graph::VertexTy a, Graph::VertexTy b) {
+                     return g.GetDegree(a) > g.GetDegree(b);
+                   });
+  return order;
+}
+
+template <GraphView G>
+std::vector<Graph::VertexTy> ComputeReverseCuthillMcKeeOrder(const G &g) {
+  Graph::OrderTy vertex_count = g.GetOrder();
+  auto by_degree = [&](Graph::VertexTy a, Graph::VertexTy b) {
+    return std::make_pair(g.GetDegree(a), a) <
+           std::make_pair(g.GetDegree(b), b);
+  };
+
+  // Every component is started from its lowest degree vertex, a cheap
+  // stand-in for a pseudo-peripheral one.
+  std::vector<Graph::VertexTy> starts(vertex_count);
+  std::iota(starts.begin(), starts.end(), 0);
+  std::sort(starts.begin(), starts.end(), by_degree);
+
+  std::vector<Graph::VertexTy> order;
+  order.reserve(vertex_count);
+  std::vector<char> visited(vertex_count, false);
+  std::vector<Graph::VertexTy> discovered;
+  for (Graph::VertexTy start : starts) {
+    if (visited[start])
+      continue;
+
+    visited[start] = true;
+    order.push_back(start);
+    for (size_t head = order.size() - 1; head != order.size(); head++) {
+      discovered.clear();
+      for (Graph::VertexTy n : g.GetNeighbors(order[head])) {
+        if (!visited[n]) {
+          visited[n] = true;
+          discovered.push_back(n);
+        }
+      }
+      std::sort(discovered.begin(), discovered.end(), by_degree);
+      order.insert(order.end(), discovered.begin(), discovered.end());
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+// A max priority queue of vertices whose keys only change by one at a time, as
+// in the Gorder paper: a doubly linked list of the vertices of each key, so
+// updates take constant time and memory stays linear in the vertex count.
+// The largest key is found lazily, falling at most as far as keys have risen.
+class UnitStepMaxQueue {
+public:
+  explicit UnitStepMaxQueue(Graph::OrderTy vertex_count)
+      : keys_(vertex_count, 0), previous_(vertex_count), next_(vertex_count),
+        heads_(1, kNone) {
+    for (Graph::VertexTy v = vertex_count; v-- != 0;)
+      Link(v);
+  }
+
+  void Increment(Graph::VertexTy v) {
+    Unlink(v);
+    keys_[v]++;
+    if (keys_[v] == heads_.size())
+      heads_.push_back(kNone);
+    Link(v);
+    top_ = std::max(top_, keys_[v]);
+  }
+
+  void Decrement(Graph::VertexTy v) {
+    assert(keys_[v] != 0);
+    Unlink(v);
+    keys_[v]--;
+    Link(v);
+  }
+
+  void Remove(Graph::VertexTy v) { Unlink(v); }
+
+  // Removes and returns a vertex of the largest key, the one that reached it
+  // last.  The queue must not be empty.
+  Graph::VertexTy PopMax() {
+    while (heads_[top_] == kNone)
+      top_--;
+    Graph::VertexTy v = heads_[top_];
+    Unlink(v);
+    return v;
+  }
+
+private:
+  static constexpr Graph::VertexTy kNone =
+      std::numeric_limits<Graph::VertexTy>::max();
+
+  void Link(Graph::VertexTy v) {
+    Graph::VertexTy &head = heads_[keys_[v]];
+    previous_[v] = kNone;
+    next_[v] = head;
+    if (head != kNone)
+      previous_[head] = v;
+    head = v;
+  }
+
+  void Unlink(Graph::VertexTy v) {
+    if (previous_[v] != kNone)
+      next_[previous_[v]] = next_[v];
+    else
+      heads_[keys_[v]] = next_[v];
+    if (next_[v] != kNone)
+      previous_[next_[v]] = previous_[v];
+  }
+
+  std::vector<Graph::OrderTy> keys_;
+  std::vector<Graph::VertexTy> previous_;
+  std::vector<Graph::VertexTy> next_;
+  std::vector<Graph::VertexTy> heads_;
+  Graph::OrderTy top_ = 0;
+};
+
+template <GraphView G>
+std::vector<Graph::VertexTy>
+ComputeGorderOrder(const G &g, const ReorderOptions &options) {
+  Graph::OrderTy vertex_count = g.GetOrder();
+  if (vertex_count == 0)
+    return {};
+
+  // The key of `u` in `queue` is the number of neighbors and shared neighbors
+  // it has among the vertices in the window.
+  std::vector<char> placed(vertex_count, false);
+  UnitStepMaxQueue queue(vertex_count);
+
+  std::vector<Graph::VertexTy> neighbors;
+  auto update_scores = [&](Graph::VertexTy v, bool entering) {
+    auto update = [&](Graph::VertexTy u) {
+      if (placed[u])
+        return;
+      if (entering)
+        queue.Increment(u);
+      else
+        queue.Decrement(u);
+    };
+
+    // GetNeighbors may reuse its storage on the next call, so take a copy
+    // before looking at the neighbors of neighbors.
+    auto v_neighbors = g.GetNeighbors(v);
+    neighbors.assign(v_neighbors.begin(), v_neighbors.end());
+    for (Graph::VertexTy u : neighbors) {
+      update(u);
+      if (g.GetDegree(u) > options.gorder_max_hub_degree)
+        continue;
+      for (Graph::VertexTy w : g.GetNeighbors(u))
+        if (w != v)
+          update(w);
+    }
+  };
+
+  Graph::VertexTy start = 0;
+  for (Graph::VertexTy v = 1; v != vertex_count; v++)
+    if (g.GetDegree(v) > g.GetDegree(start))
+      start = v;
+
+  std::vector<Graph::VertexTy> order;
+  order.reserve(vertex_count);
+  Graph::VertexTy next = start;
+  queue.Remove(start);
+  while (true) {
+    placed[next] = true;
+    order.push_back(next);
+    update_scores(next, /*entering=*/true);
+    if (order.size() > options.gorder_window)
+      update_scores(order[order.size() - 1 - options.gorder_window],
+                    /*entering=*/false);
+
+    if (order.size() == vertex_count)
+      break;
+
+    next = queue.PopMax();
+  }
+
+  return order;
+}
+} // namespace
+
+std::unique_ptr<Graph>
+ApplyPermutation(Graph *g, const std::vector<Graph::VertexTy> &permutation) {
+  Graph::OrderTy order = g->GetOrder();
+  assert(permutation.size() == order);
+  std::vector<Graph::VertexTy> inverse = InvertPermutation(permutation);
+
+  std::vector<size_t> offsets(order + 1, 0);
+  for (Graph::VertexTy u = 0; u != order; u++)
+    offsets[u + 1] = offsets[u] + g->GetDegree(inverse[u]);
+
+  std::vector<Graph::VertexTy> neighbors(offsets.back());
+  unsigned tasks = GetTaskCount(neighbors.size(), kRelabelGrain);
+  ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+    std::vector<Graph::VertexTy> scratch;
+    for (Graph::VertexTy u = begin; u != end; u++) {
+      auto old_neighbors = g->GetNeighbors(inverse[u], &scratch);
+      assert(old_neighbors.size() == offsets[u + 1] - offsets[u]);
+      std::transform(old_neighbors.begin(), old_neighbors.end(),
+                     neighbors.begin() + offsets[u],
+                     [&](Graph::VertexTy n) { return permutation[n]; });
+    }
+  });
+
+  return CreateConcreteGraphFromAdjacency(std::move(offsets),
+                                          std::move(neighbors));
+}
+
+Reordering ReorderGraph(Graph *g, ReorderStrategy strategy,
+                        const ReorderOptions &options) {
+  Reordering result;
+  result.inverse = VisitGraphView(g, [&](const auto &view) {
+    switch (strategy) {
+    case ReorderStrategy::kReverseCuthillMcKee:
+      return ComputeReverseCuthillMcKeeOrder(view);
+    case ReorderStrategy::kDegreeSort:
+      return ComputeDegreeSortOrder(view);
+    case ReorderStrategy::kGorder:
+      return ComputeGorderOrder(view, options);
+    }
+    assert(false && "Unknown strategy");
+    return std::vector<Graph::VertexTy>();
+  });
+  result.permutation = InvertPermutation(result.inverse);
+  result.graph = ApplyPermutation(g, result.permutation);
+  return result;
+}
+
+LocalityMetrics ComputeLocalityMetrics(Graph *g) {
+  LocalityMetrics metrics;
+  size_t edge_count = 0;
+  double total_gap = 0;
+  double total_log_gap = 0;
+  ForEachEdgeChunk(g, [&](std::span<const Graph::EdgeTy> edges) {
+    for (auto [a, b] : edges) {
+      if (a == b)
+        continue;
+      Graph::OrderTy gap = b - a;
+      edge_count++;
+      total_gap += gap;
+      total_log_gap += std::log2(static_cast<double>(gap));
+      metrics.bandwidth = std::max(metrics.bandwidth, gap);
+    }
+  });
+
+  if (edge_count != 0) {
+    metrics.average_gap = total_gap / edge_count;
+    metrics.average_log_gap = total_log_gap / edge_count;
+  }
+  return metrics;
+}
+} // namespace kb
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace kb {
+enum class ReorderStrategy {
+  // Reverse Cuthill-McKee: a breadth first order from a low degree vertex of
+  // every component, visiting neighbors by increasing degree, then reversed.
+  // Keeps neighbors close together and minimizes bandwidth.
+  kReverseCuthillMcKee,
+
+  // Vertices by decreasing degree, so that the hubs most scans touch share
+  // cache lines.
+  kDegreeSort,
+
+  // The Gorder greedy heuristic: each next vertex is the one with the most
+  // neighbors and shared neighbors among the last `gorder_window` placed.
+  kGorder,
+};
+
+struct ReorderOptions {
+  unsigned gorder_window = 5;
+
+  // Gorder does not count shared neighbors through vertices of higher
+  // degree, which would otherwise dominate its running time.
+  Graph::OrderTy gorder_max_hub_degree = 256;
+};
+
+struct Reordering {
+  // The relabeled graph, stored in CSR form.
+  std::unique_ptr<Graph> graph;
+
+  // `permutation[v]` is the new label of the original vertex `v`, and
+  // `inverse[u]` is the original vertex now labeled `u`.
+  std::vector<Graph::VertexTy> permutation;
+  std::vector<Graph::VertexTy> inverse;
+};
+
+Reordering ReorderGraph(Graph *g, ReorderStrategy strategy,
+                        const ReorderOptions &options = {});
+
+// Relabels `g` so that the original vertex `v` becomes `permutation[v]`.
+std::unique_ptr<Graph>
+ApplyPermutation(Graph *g, const std::vector<Graph::VertexTy> &permutation);
+
+// How far apart the endpoints of edges are, over all edges but self loops.
+// Smaller is better for every metric.
+struct LocalityMetrics {
+  double average_gap = 0;
+
+  // The average of log2(gap): roughly the number of cache levels a neighbor
+  // access misses, and the measure Gorder optimizes.
+  double average_log_gap = 0;
+
+  // The largest gap.
+  Graph::OrderTy bandwidth = 0;
+};
+
+LocalityMetrics ComputeLocalityMetrics(Graph *g);
+} // namespace kb
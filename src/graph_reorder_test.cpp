@@ -0,0 +1,102 @@
+#include "graph_reorder.hpp"
+
+#include "graph_zoo.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace kb;
+
+// A path whose vertices are labeled 0, 5, 10, ... modulo a prime, so that
+// consecutive vertices are far apart.
+static std::unique_ptr<Graph> CreateScrambledPath(Graph::OrderTy order) {
+  std::vector<Graph::EdgeTy> edges;
+  for (Graph::VertexTy i = 0; i + 1 < order; i++)
+    edges.push_back({i * 5 % order, (i + 1) * 5 % order});
+  return CreateConcreteGraph(order, edges);
+}
+
+static bool IsRelabeling(Graph *original, const Reordering &reordering) {
+  Graph::OrderTy order = original->GetOrder();
+  if (reordering.graph->GetOrder() != order ||
+      reordering.permutation.size() != order ||
+      reordering.inverse.size() != order)
+    return false;
+
+  for (Graph::VertexTy v = 0; v < order; v++)
+    if (reordering.inverse[reordering.permutation[v]] != v)
+      return false;
+
+  std::vector<Graph::EdgeTy> expected_edges;
+  for (auto [a, b] : Iterate(original->GetEdges())) {
+    Graph::VertexTy new_a = reordering.permutation[a];
+    Graph::VertexTy new_b = reordering.permutation[b];
+    expected_edges.push_back({std::min(new_a, new_b), std::max(new_a, new_b)});
+  }
+  std::sort(expected_edges.begin(), expected_edges.end());
+
+  std::vector<Graph::EdgeTy> actual_edges;
+  for (auto e : Iterate(reordering.graph->GetEdges()))
+    actual_edges.push_back(e);
+  std::sort(actual_edges.begin(), actual_edges.end());
+  return actual_edges == expected_edges &&
+         !CheckConsistency(reordering.graph.get()).has_value();
+}
+
+static void TestLocalityMetrics() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 3}, {2, 2}, {0, 4}};
+  std::unique_ptr<Graph> g = CreateConcreteGraph(5, edges);
+  LocalityMetrics metrics = ComputeLocalityMetrics(g.get());
+  CHECK_EQ(metrics.bandwidth, 4);
+  CHECK_EQ(metrics.average_gap, 7.0 / 3.0);
+  CHECK_EQ(metrics.average_log_gap, 1.0);
+}
+
+static void TestReverseCuthillMcKee_Path() {
+  auto path = CreateScrambledPath(101);
+  CHECK_GT(ComputeLocalityMetrics(path.get()).bandwidth, 1);
+
+  Reordering reordering =
+      ReorderGraph(path.get(), ReorderStrategy::kReverseCuthillMcKee);
+  CHECK(IsRelabeling(path.get(), reordering));
+  CHECK_EQ(ComputeLocalityMetrics(reordering.graph.get()).bandwidth, 1);
+}
+
+static void TestDegreeSort() {
+  auto bipartite = CreateCompleteBipartiteGraph(5, 2);
+  Reordering reordering =
+      ReorderGraph(bipartite.get(), ReorderStrategy::kDegreeSort);
+  CHECK(IsRelabeling(bipartite.get(), reordering));
+  CHECK_EQ(reordering.inverse[0], 5);
+  CHECK_EQ(reordering.inverse[1], 6);
+  for (Graph::VertexTy v = 1; v < 7; v++)
+    CHECK_GE(reordering.graph->GetDegree(v - 1),
+             reordering.graph->GetDegree(v));
+}
+
+static void TestGorder() {
+  auto path = CreateScrambledPath(101);
+  Reordering reordering = ReorderGraph(path.get(), ReorderStrategy::kGorder);
+  CHECK(IsRelabeling(path.get(), reordering));
+  CHECK_LT(ComputeLocalityMetrics(reordering.graph.get()).average_log_gap,
+           ComputeLocalityMetrics(path.get()).average_log_gap);
+
+  auto product = CreateReplacementProduct(CreateCompleteGraph(6, false),
+                                          CreateRingGraph(5));
+  for (ReorderStrategy strategy :
+       {ReorderStrategy::kReverseCuthillMcKee, ReorderStrategy::kDegreeSort,
+        ReorderStrategy::kGorder}) {
+    Reordering product_reordering = ReorderGraph(product.get(), strategy);
+    CHECK(IsRelabeling(product.get(), product_reordering));
+  }
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestLocalityMetrics)                                                       \
+  F(TestReverseCuthillMcKee_Path)                                              \
+  F(TestDegreeSort)                                                            \
+  F(TestGorder)                                                                \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -1,7 +1,11 @@
 #include "graph.hpp"
+#include "graph_view.hpp"
+#include "parallel.hpp"
 #include "test.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <vector>
 
 using namespace kb;
@@ -32,10 +36,246 @@ static void TestIterators_2() {
   CHECK(!CheckConsistency(concrete_graph.get()).has_value());
 }
 
+static void TestGetEdgesContainingVertex() {
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 2}, {0, 4}, {1, 3}, {3, 1}, {4, 2},
+  };
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(5, edges);
+
+  std::vector<std::vector<Graph::VertexTy>> expected_neighbors = {
+      {0, 2, 4}, {3}, {0, 4}, {1}, {0, 2},
+  };
+  for (Graph::VertexTy v = 0; v < 5; v++) {
+    std::vector<Graph::VertexTy> neighbors;
+    for (auto e : Iterate(concrete_graph->GetEdgesContainingVertex(v))) {
+      CHECK_EQ(e.first, v);
+      neighbors.push_back(e.second);
+    }
+    CHECK(neighbors == expected_neighbors[v]);
+  }
+
+  std::vector<Graph::EdgeTy> unique_edges = {
+      {0, 0}, {0, 2}, {0, 4}, {1, 3}, {2, 4},
+  };
+  std::unique_ptr<Graph> clone = concrete_graph->Clone();
+  CHECK_EDGES_EQ(unique_edges, clone);
+}
+
+static void TestGetNeighbors() {
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 2}, {0, 4}, {1, 3}, {4, 2},
+  };
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(5, edges);
+
+  std::vector<Graph::VertexTy> scratch;
+  for (Graph::VertexTy v = 0; v < 5; v++) {
+    std::vector<Graph::VertexTy> expected_neighbors;
+    for (auto e : Iterate(concrete_graph->GetEdgesContainingVertex(v)))
+      expected_neighbors.push_back(e.second);
+
+    auto neighbors = concrete_graph->GetNeighbors(v, &scratch);
+    CHECK(std::equal(neighbors.begin(), neighbors.end(),
+                     expected_neighbors.begin(), expected_neighbors.end()));
+  }
+
+}
+
+static void TestCompactStorage() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}, {2, 0}};
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(3, edges);
+  CHECK(concrete_graph->GetCompactCsrView() != nullptr);
+  CHECK(concrete_graph->GetWideCsrView() == nullptr);
+
+  // Compact neighbor lists are widened into the scratch buffer.
+  std::vector<Graph::VertexTy> scratch;
+  auto neighbors = concrete_graph->GetNeighbors(1, &scratch);
+  CHECK_EQ(neighbors.data(), scratch.data());
+  CHECK_EQ(neighbors.size(), 2);
+
+  // Wide adjacency is narrowed when the order allows it.
+  std::unique_ptr<Graph> from_adjacency = CreateConcreteGraphFromAdjacency(
+      {0, 2, 4, 6}, std::vector<Graph::VertexTy>{1, 2, 2, 0, 0, 1});
+  CHECK(from_adjacency->GetCompactCsrView() != nullptr);
+  CHECK_EDGES_EQ(edges, from_adjacency);
+}
+
+static void TestCloneSharesStorage() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}, {2, 0}};
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(3, edges);
+  std::unique_ptr<Graph> clone = concrete_graph->Clone();
+  CHECK_EQ(clone->GetCompactCsrView()->GetNeighborArray().data(),
+           concrete_graph->GetCompactCsrView()->GetNeighborArray().data());
+
+  // The storage outlives the graph it was built for.
+  concrete_graph.reset();
+  CHECK(!CheckConsistency(clone.get()).has_value());
+  CHECK_EDGES_EQ(edges, clone);
+}
+
+static void TestCreateConcreteGraph_AssumeUnique() {
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 2}, {4, 0}, {1, 3}, {2, 4},
+  };
+  std::unique_ptr<Graph> concrete_graph =
+      CreateConcreteGraph(5, edges, /*assume_unique=*/true);
+  CHECK(!CheckConsistency(concrete_graph.get()).has_value());
+  CHECK_EDGES_EQ(edges, concrete_graph);
+}
+
+static void TestCreateConcreteGraph_Parallel() {
+  // Enough edges to split construction across several tasks, with every edge
+  // repeated in both orientations.
+  const Graph::OrderTy order = 20000;
+  std::vector<Graph::EdgeTy> edges;
+  std::set<Graph::EdgeTy> expected_edge_set;
+  for (Graph::VertexTy i = 0; i < order; i++) {
+    for (Graph::VertexTy step : {1, 7, 131, 19999}) {
+      Graph::VertexTy j = (i * step + 3) % order;
+      edges.push_back({i, j});
+      edges.push_back({j, i});
+      expected_edge_set.insert({std::min(i, j), std::max(i, j)});
+    }
+  }
+
+  SetDefaultConcurrency(4);
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(order, edges);
+  SetDefaultConcurrency(0);
+
+  CHECK(!CheckConsistency(concrete_graph.get()).has_value());
+  std::vector<Graph::EdgeTy> expected_edges(expected_edge_set.begin(),
+                                            expected_edge_set.end());
+  CHECK_EDGES_EQ(expected_edges, concrete_graph);
+
+  std::vector<Graph::VertexTy> scratch;
+  for (Graph::VertexTy v = 0; v < order; v++) {
+    auto neighbors = concrete_graph->GetNeighbors(v, &scratch);
+    CHECK(std::is_sorted(neighbors.begin(), neighbors.end()));
+  }
+}
+
+static void TestAppendUniqueEdges() {
+  std::vector<Graph::EdgeTy> edges = {
+      {0, 0}, {0, 2}, {4, 0}, {1, 3}, {2, 4}, {3, 2},
+  };
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(5, edges);
+
+  std::vector<Graph::EdgeTy> range_edges;
+  concrete_graph->AppendUniqueEdges(1, 3, &range_edges);
+  std::vector<Graph::EdgeTy> expected_range_edges = {{1, 3}, {2, 3}, {2, 4}};
+  CHECK(range_edges == expected_range_edges);
+
+  std::vector<Graph::VertexTy> boundaries =
+      PartitionVertices(concrete_graph.get(), 3);
+  CHECK_EQ(boundaries.size(), 4);
+  CHECK_EQ(boundaries.front(), 0);
+  CHECK_EQ(boundaries.back(), 5);
+  CHECK(std::is_sorted(boundaries.begin(), boundaries.end()));
+
+  std::vector<Graph::EdgeTy> partitioned_edges;
+  for (int i = 0; i < 3; i++)
+    concrete_graph->AppendUniqueEdges(boundaries[i], boundaries[i + 1],
+                                      &partitioned_edges);
+
+  std::vector<Graph::EdgeTy> chunked_edges;
+  ForEachEdgeChunk(
+      concrete_graph.get(),
+      [&](std::span<const Graph::EdgeTy> chunk) {
+        CHECK(!chunk.empty());
+        chunked_edges.insert(chunked_edges.end(), chunk.begin(), chunk.end());
+      },
+      /*chunk_size=*/2);
+
+  std::vector<Graph::EdgeTy> iterated_edges;
+  for (auto e : Iterate(concrete_graph->GetEdges()))
+    iterated_edges.push_back(e);
+  CHECK(partitioned_edges == iterated_edges);
+  CHECK(chunked_edges == iterated_edges);
+  CHECK_EDGES_EQ(edges, concrete_graph);
+}
+
+namespace {
+// Serves the given adjacency lists verbatim, even if they are inconsistent.
+class AdjacencyListGraph final : public Graph {
+public:
+  explicit AdjacencyListGraph(std::vector<std::vector<VertexTy>> adjacency)
+      : adjacency_(std::move(adjacency)) {}
+
+  class ListEdgeIterator final : public EdgeIterator {
+  public:
+    ListEdgeIterator(VertexTy v, const std::vector<VertexTy> &neighbors)
+        : v_(v), neighbors_(neighbors) {}
+
+    EdgeTy Get() override { return {v_, neighbors_[i_]}; }
+    void Next() override { i_++; }
+    bool IsAtEnd() override { return i_ == neighbors_.size(); }
+
+  private:
+    VertexTy v_;
+    const std::vector<VertexTy> &neighbors_;
+    size_t i_ = 0;
+  };
+
+  std::unique_ptr<EdgeIterator> GetEdgesContainingVertex(VertexTy v) override {
+    return std::make_unique<ListEdgeIterator>(v, adjacency_[v]);
+  }
+
+  OrderTy GetOrder() override { return adjacency_.size(); }
+
+  std::unique_ptr<Graph> Clone() override {
+    return std::make_unique<AdjacencyListGraph>(adjacency_);
+  }
+
+private:
+  std::vector<std::vector<VertexTy>> adjacency_;
+};
+} // namespace
+
+static void TestCheckConsistency_Violations() {
+  AdjacencyListGraph graph({{1, 1}, {}, {0}});
+  auto report = CheckConsistency(&graph);
+  CHECK(report.has_value());
+  CHECK_EQ(*report,
+           "Edge (0, 1) found in vertex adjacency list for 0 but not in edge "
+           "list\n"
+           "Edge (2, 0) found in vertex adjacency list for 2 but not in edge "
+           "list\n"
+           "The following edges were found in the edge list but not in any "
+           "vertex adjacency list: (1, 0) \n");
+}
+
+static void TestCheckConsistency_Sampled() {
+  ConsistencyCheckOptions options;
+  options.sample_size = 100;
+
+  AdjacencyListGraph inconsistent_graph({{1}, {}, {0}});
+  auto report = CheckConsistency(&inconsistent_graph, options);
+  CHECK(report.has_value());
+  CHECK_EQ(*report,
+           "Edge (0, 1) found in vertex adjacency list for 0 but not in vertex "
+           "adjacency list for 1\n"
+           "Edge (2, 0) found in vertex adjacency list for 2 but not in vertex "
+           "adjacency list for 0\n");
+
+  std::vector<Graph::EdgeTy> edges;
+  for (Graph::VertexTy i = 0; i < 1000; i++)
+    edges.push_back({i, (i * 7 + 1) % 1000});
+  std::unique_ptr<Graph> concrete_graph = CreateConcreteGraph(1000, edges);
+  CHECK(!CheckConsistency(concrete_graph.get(), options).has_value());
+}
+
 #define TEST_LIST(F)                                                           \
   F(TestIterators_0)                                                           \
   F(TestIterators_1)                                                           \
   F(TestIterators_2)                                                           \
+  F(TestGetEdgesContainingVertex)                                              \
+  F(TestGetNeighbors)                                                          \
+  F(TestCompactStorage)                                                        \
+  F(TestCloneSharesStorage)                                                    \
+  F(TestCreateConcreteGraph_AssumeUnique)                                      \
+  F(TestCreateConcreteGraph_Parallel)                                          \
+  F(TestAppendUniqueEdges)                                                     \
+  F(TestCheckConsistency_Violations)                                           \
+  F(TestCheckConsistency_Sampled)                                              \
   (void)0;
 
 DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "bitset.hpp"
+#include "graph.hpp"
+
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace kb {
+// A graph view exposes the adjacency of a graph through non-virtual calls so
+// that algorithms templated on it can be inlined and vectorized.  The range
+// returned by GetNeighbors is only guaranteed to be valid until the next call
+// to GetNeighbors on the same view.  GetDegree must not walk the adjacency.
+template <typename G>
+concept GraphView = requires(const G &g, Graph::VertexTy v) {
+  { g.GetOrder() } -> std::convertible_to<Graph::OrderTy>;
+  { g.GetDegree(v) } -> std::convertible_to<Graph::OrderTy>;
+  { g.GetNeighbors(v) } -> std::ranges::forward_range;
+  requires std::convertible_to<
+      std::ranges::range_value_t<decltype(g.GetNeighbors(v))>,
+      Graph::VertexTy>;
+};
+
+// Whether every vertex of a graph with `order` vertices fits in a
+// CompactVertexTy.
+inline bool FitsCompactVertexTy(Graph::OrderTy order) {
+  return order == 0 || order - 1 <= std::numeric_limits<CompactVertexTy>::max();
+}
+
+// A view over adjacency stored in compressed sparse row form: the neighbors of
+// `v` are `neighbors[offsets[v]]` to `neighbors[offsets[v + 1]]`, each stored
+// as an `IndexTy`.
+template <typename IndexTy> class CsrGraphView {
+public:
+  // An empty graph.
+  CsrGraphView() : offsets_(kEmptyOffsets) {}
+
+  CsrGraphView(std::span<const size_t> offsets,
+               std::span<const IndexTy> neighbors)
+      : offsets_(offsets), neighbors_(neighbors) {
+    assert(!offsets_.empty());
+    assert(offsets_.back() == neighbors_.size());
+  }
+
+  Graph::OrderTy GetOrder() const { return offsets_.size() - 1; }
+
+  Graph::OrderTy GetDegree(Graph::VertexTy v) const {
+    return offsets_[v + 1] - offsets_[v];
+  }
+
+  std::span<const IndexTy> GetNeighbors(Graph::VertexTy v) const {
+    return neighbors_.subspan(offsets_[v], offsets_[v + 1] - offsets_[v]);
+  }
+
+  std::span<const size_t> GetOffsets() const { return offsets_; }
+  std::span<const IndexTy> GetNeighborArray() const { return neighbors_; }
+
+private:
+  static constexpr size_t kEmptyOffsets[1] = {0};
+
+  std::span<const size_t> offsets_;
+  std::span<const IndexTy> neighbors_;
+};
+
+// A view over adjacency stored as a bit matrix: row `v` is the set of
+// neighbors of `v`, packed into `words_per_row` words.  Kernels can specialize
+// on this view to work on whole rows with the bitset operations.
+class BitMatrixView {
+public:
+  BitMatrixView() = default;
+
+  BitMatrixView(std::span<const BitWord> words,
+                std::span<const Graph::OrderTy> degrees)
+      : words_(words), degrees_(degrees),
+        words_per_row_(bitset::GetWordCount(degrees.size())) {
+    assert(words_.size() == degrees_.size() * words_per_row_);
+  }
+
+  Graph::OrderTy GetOrder() const { return degrees_.size(); }
+
+  Graph::OrderTy GetDegree(Graph::VertexTy v) const { return degrees_[v]; }
+
+  bitset::ElementRange GetNeighbors(Graph::VertexTy v) const {
+    return bitset::ElementRange(GetRow(v));
+  }
+
+  std::span<const BitWord> GetRow(Graph::VertexTy v) const {
+    return words_.subspan(v * words_per_row_, words_per_row_);
+  }
+
+  size_t GetWordsPerRow() const { return words_per_row_; }
+
+private:
+  std::span<const BitWord> words_;
+  std::span<const Graph::OrderTy> degrees_;
+  size_t words_per_row_ = 0;
+};
+
+// Adapts an arbitrary `Graph` to the GraphView interface.  Every
+// GetNeighbors call is a virtual call, but there is no per-edge dispatch.
+class VirtualGraphView {
+public:
+  explicit VirtualGraphView(Graph *g) : graph_(g) {}
+
+  Graph::OrderTy GetOrder() const { return graph_->GetOrder(); }
+
+  Graph::OrderTy GetDegree(Graph::VertexTy v) const {
+    return graph_->GetDegree(v);
+  }
+
+  std::span<const Graph::VertexTy> GetNeighbors(Graph::VertexTy v) const {
+    return graph_->GetNeighbors(v, &scratch_);
+  }
+
+private:
+  Graph *graph_;
+  mutable std::vector<Graph::VertexTy> scratch_;
+};
+
+static_assert(GraphView<CsrGraphView<CompactVertexTy>>);
+static_assert(GraphView<CsrGraphView<Graph::VertexTy>>);
+static_assert(GraphView<BitMatrixView>);
+static_assert(GraphView<VirtualGraphView>);
+
+// Calls `fn` with the most specific view `g` supports.
+template <typename Fn> decltype(auto) VisitGraphView(Graph *g, Fn &&fn) {
+  if (const auto *bit_matrix = g->GetBitMatrixView())
+    return fn(*bit_matrix);
+  if (const auto *compact = g->GetCompactCsrView())
+    return fn(*compact);
+  if (const auto *wide = g->GetWideCsrView())
+    return fn(*wide);
+  return fn(VirtualGraphView(g));
+}
+} // namespace kb
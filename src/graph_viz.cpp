@@ -2,7 +2,6 @@
 
 #include <cstdlib>
 #include <fstream>
-#include <set>
 #include <sstream>
 
 namespace kb {
@@ -10,18 +9,14 @@ std::string ExportToGraphviz(Graph *g, std::string name) {
   std::stringstream out;
 
   out << "graph " << name << " {\n";
-  std::set<Graph::VertexTy> unconnected_vertices;
-  for (auto v : Iterate(g->GetVertices()))
-    unconnected_vertices.insert(v);
-
-  for (auto e : Iterate(g->GetEdges())) {
-    out << "  " << e.first << " -- " << e.second << "\n";
-    unconnected_vertices.erase(e.first);
-    unconnected_vertices.erase(e.second);
-  }
-
-  for (auto v : unconnected_vertices)
-    out << "  " << v << "\n";
+  ForEachEdgeChunk(g, [&](std::span<const Graph::EdgeTy> edges) {
+    for (auto e : edges)
+      out << "  " << e.first << " -- " << e.second << "\n";
+  });
+
+  for (Graph::VertexTy v = 0, e = g->GetOrder(); v != e; v++)
+    if (g->GetDegree(v) == 0)
+      out << "  " << v << "\n";
 
   out << "}\n";
   return out.str();
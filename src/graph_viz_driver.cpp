@@ -1,7 +1,11 @@
+#include "dynamic_graph.hpp"
 #include "graph_analysis.hpp"
+#include "graph_file.hpp"
+#include "graph_reorder.hpp"
 #include "graph_viz.hpp"
 #include "graph_zoo.hpp"
 #include "random_graph.hpp"
+#include "spectral.hpp"
 
 #include <cctype>
 #include <iostream>
@@ -189,6 +193,53 @@ public:
     return CreateRandomSparseGraph(rng.get(), *maybe_order, *maybe_avg_degree);
   }
 
+  GraphResult MakeLoadedGraph(const std::string &cmd,
+                              const std::vector<std::string> &cmd_words,
+                              bool *matched) {
+    *matched = cmd_words[kAssignOpOffset + 1] == "load";
+    if (!*matched)
+      return std::unique_ptr<Graph>(nullptr);
+
+    if (cmd_words.size() != kAssignOpOffset + 3)
+      return "Expected command of the form \"x = load <path>\", got \"" +
+             cmd + "\"";
+
+    // Files typed in at the prompt are checked in full before use.
+    return OpenGraphFile(cmd_words[kAssignOpOffset + 2], {.validate = true});
+  }
+
+  GraphResult MakeReorderedGraph(const std::string &cmd,
+                                 const std::vector<std::string> &cmd_words,
+                                 bool *matched) {
+    *matched = cmd_words[kAssignOpOffset + 1] == "reorder";
+    if (!*matched)
+      return std::unique_ptr<Graph>(nullptr);
+
+    std::string error_msg = "Expected command of the form \"x = reorder "
+                            "<graph> <rcm|degree|gorder>\", got \"" +
+                            cmd + "\"";
+    if (cmd_words.size() != kAssignOpOffset + 4)
+      return error_msg;
+
+    const std::string &graph_name = cmd_words[kAssignOpOffset + 2];
+    auto it = graphs_.find(graph_name);
+    if (it == graphs_.end())
+      return "Could not find graph " + graph_name;
+
+    const std::string &strategy_name = cmd_words[kAssignOpOffset + 3];
+    ReorderStrategy strategy;
+    if (strategy_name == "rcm")
+      strategy = ReorderStrategy::kReverseCuthillMcKee;
+    else if (strategy_name == "degree")
+      strategy = ReorderStrategy::kDegreeSort;
+    else if (strategy_name == "gorder")
+      strategy = ReorderStrategy::kGorder;
+    else
+      return error_msg;
+
+    return ReorderGraph(it->second.get(), strategy).graph;
+  }
+
   GraphResult MakeGraph(const std::string &cmd,
                         const std::vector<std::string> &cmd_words) {
     GraphResult result;
@@ -206,6 +257,8 @@ public:
     MAKE_GRAPH_CASE(Bipartite);
     MAKE_GRAPH_CASE(ReplacementProduct);
     MAKE_GRAPH_CASE(Random);
+    MAKE_GRAPH_CASE(Loaded);
+    MAKE_GRAPH_CASE(Reordered);
 
 #undef MAKE_GRAPH_CASE
 
@@ -250,6 +303,119 @@ public:
     return std::nullopt;
   }
 
+  std::optional<std::string>
+  SaveGraph(const std::string &cmd, const std::vector<std::string> &cmd_words,
+            bool *matched) {
+    if (cmd_words.size() != 3 || cmd_words[0] != "save") {
+      *matched = false;
+      return std::nullopt;
+    }
+
+    *matched = true;
+    auto it = graphs_.find(cmd_words[1]);
+    if (it == graphs_.end())
+      return "Could not find constructed graph \"" + cmd_words[1] + "\"";
+
+    return WriteGraphFile(it->second.get(), cmd_words[2]);
+  }
+
+  std::optional<std::string>
+  PrintLocality(const std::string &cmd,
+                const std::vector<std::string> &cmd_words, bool *matched) {
+    if (cmd_words.size() != 2 || cmd_words[0] != "locality") {
+      *matched = false;
+      return std::nullopt;
+    }
+
+    *matched = true;
+    auto it = graphs_.find(cmd_words[1]);
+    if (it == graphs_.end())
+      return "Could not find constructed graph \"" + cmd_words[1] + "\"";
+
+    LocalityMetrics metrics = ComputeLocalityMetrics(it->second.get());
+    std::cout << "average gap " << metrics.average_gap << ", average log gap "
+              << metrics.average_log_gap << ", bandwidth "
+              << metrics.bandwidth << "\n";
+    return std::nullopt;
+  }
+
+  std::optional<std::string>
+  PrintSpectralBounds(const std::string &cmd,
+                      const std::vector<std::string> &cmd_words,
+                      bool *matched) {
+    if (cmd_words.size() != 2 || cmd_words[0] != "spectral") {
+      *matched = false;
+      return std::nullopt;
+    }
+
+    *matched = true;
+    auto it = graphs_.find(cmd_words[1]);
+    if (it == graphs_.end())
+      return "Could not find constructed graph \"" + cmd_words[1] + "\"";
+
+    SpectralExpansionBounds bounds =
+        ComputeSpectralExpansionBounds(it->second.get());
+    std::cout << "spectral gap " << bounds.spectral_gap
+              << (bounds.converged ? "" : " (not converged)")
+              << ", cheeger constant <= " << bounds.cheeger_upper_bound
+              << ", estimated >= " << bounds.cheeger_lower_estimate << "\n";
+
+    LocalCluster cluster = FindLocalCluster(it->second.get());
+    std::cout << "local cluster of " << cluster.set.size()
+              << " vertices around " << cluster.seed_vertex
+              << ", cheeger constant <= " << cluster.cheeger_upper_bound
+              << "\n";
+    return std::nullopt;
+  }
+
+  // Graphs are converted to a DynamicGraph the first time they are edited, and
+  // edited in place from then on.
+  std::optional<std::string>
+  EditGraph(const std::string &cmd, const std::vector<std::string> &cmd_words,
+            bool *matched) {
+    if (cmd_words.empty() ||
+        (cmd_words[0] != "add_edge" && cmd_words[0] != "remove_edge")) {
+      *matched = false;
+      return std::nullopt;
+    }
+
+    *matched = true;
+    std::string error_msg = "Expected command of the form \"" + cmd_words[0] +
+                            " <graph> <vertex> <vertex>\", got \"" + cmd +
+                            "\"";
+    if (cmd_words.size() != 4)
+      return error_msg;
+
+    auto it = graphs_.find(cmd_words[1]);
+    if (it == graphs_.end())
+      return "Could not find constructed graph \"" + cmd_words[1] + "\"";
+
+    auto maybe_a = StrToL(cmd_words[2]);
+    auto maybe_b = StrToL(cmd_words[3]);
+    if (!maybe_a || !maybe_b)
+      return error_msg;
+    Graph::OrderTy order = it->second->GetOrder();
+    if (*maybe_a < 0 || *maybe_b < 0)
+      return "Vertex out of range for graph of order " + std::to_string(order);
+    auto a = static_cast<Graph::VertexTy>(*maybe_a);
+    auto b = static_cast<Graph::VertexTy>(*maybe_b);
+    if (a >= order || b >= order)
+      return "Vertex out of range for graph of order " + std::to_string(order);
+
+    auto *graph = dynamic_cast<DynamicGraph *>(it->second.get());
+    if (!graph) {
+      auto dynamic_graph = CreateDynamicGraph(it->second.get());
+      graph = dynamic_graph.get();
+      it->second = std::move(dynamic_graph);
+    }
+
+    if (cmd_words[0] == "add_edge")
+      graph->AddEdge(a, b);
+    else
+      graph->RemoveEdge(a, b);
+    return std::nullopt;
+  }
+
   std::optional<std::string> RunCommand(std::string cmd, bool *exit) {
     trim(&cmd);
     if (cmd == "quit" || cmd == "exit") {
@@ -271,6 +437,10 @@ public:
 
     RUN_CMD_CASE(MakeGraphAndAssign);
     RUN_CMD_CASE(VisualizeGraph);
+    RUN_CMD_CASE(SaveGraph);
+    RUN_CMD_CASE(EditGraph);
+    RUN_CMD_CASE(PrintLocality);
+    RUN_CMD_CASE(PrintSpectralBounds);
 
     return "\"" + cmd + "\"" + " does not match any commands!";
   }
@@ -1,21 +1,25 @@
 #include "graph_zoo.hpp"
 
+#include "bit_matrix_graph.hpp"
 #include "graph_analysis.hpp"
 #include "logging.hpp"
 
+#include <algorithm>
 #include <vector>
 
 namespace kb {
+// Complete graphs are as dense as graphs get, so they are stored as bit
+// matrices.
 std::unique_ptr<Graph> CreateCompleteGraph(int k, bool self_loops) {
-  std::vector<Graph::EdgeTy> edges;
+  auto graph = std::make_unique<BitMatrixGraph>(k);
   for (int i = 0; i < k; i++) {
     if (self_loops)
-      edges.push_back({i, i});
+      graph->AddEdge(i, i);
     for (int j = i + 1; j < k; j++)
-      edges.push_back({i, j});
+      graph->AddEdge(i, j);
   }
 
-  return CreateConcreteGraph(k, edges);
+  return graph;
 }
 
 std::unique_ptr<Graph> CreateUnconnectedGraph(int k) {
@@ -27,7 +31,7 @@ std::unique_ptr<Graph> CreateCompleteBipartiteGraph(int l, int r) {
   for (int i = 0; i < l; i++)
     for (int j = 0; j < r; j++)
       edges.push_back({i, l + j});
-  return CreateConcreteGraph(l + r, edges);
+  return CreateConcreteGraph(l + r, edges, /*assume_unique=*/true);
 }
 
 namespace {
@@ -72,40 +76,10 @@ public:
     EdgeTy GetExtraEdge() {
       LOG_METHOD_ENTRY_AND_EXIT();
 
-      long index = 0;
-      EdgeTy outer_edge;
-      bool found_outer_edge = false;
-
-      for (auto e : Iterate(
-               parent_->GetOuter()->GetEdgesContainingVertex(outer_vertex_))) {
-        if (index++ == inner_vertex_) {
-          outer_edge = e;
-          found_outer_edge = true;
-          break;
-        }
-      }
-
-      assert(found_outer_edge && "Outer vertex must have degree equal to the "
-                                 "number of vertices in the "
-                                 "inner graph!");
-
-      if (outer_edge.first != outer_vertex_)
-        std::swap(outer_edge.first, outer_edge.second);
-
-      assert(outer_edge.first == outer_vertex_);
-      auto other_outer_vertex = outer_edge.second;
-
-      auto inner_iterator = parent_->GetInner()->GetVertices();
-      for (auto e : Iterate(parent_->GetOuter()->GetEdgesContainingVertex(
-               other_outer_vertex))) {
-        if (e.first == outer_vertex_ || e.second == outer_vertex_)
-          break;
-        inner_iterator->Next();
-      }
-
-      auto other_inner_vertex = inner_iterator->Get();
+      std::vector<VertexTy> scratch;
       return {parent_->Join(outer_vertex_, inner_vertex_),
-              parent_->Join(other_outer_vertex, other_inner_vertex)};
+              parent_->GetLongEdgeNeighbor(outer_vertex_, inner_vertex_,
+                                           &scratch)};
     }
 
     ReplacementProduct *parent_;
@@ -123,6 +97,44 @@ public:
     return std::make_unique<ReplacementProductEdgeIterator>(this, /*vertex=*/v);
   }
 
+  std::span<const VertexTy>
+  GetNeighbors(VertexTy v, std::vector<VertexTy> *scratch) override {
+    auto [outer_vertex, inner_vertex] = Split(v);
+    VertexTy long_edge_neighbor =
+        GetLongEdgeNeighbor(outer_vertex, inner_vertex, scratch);
+
+    auto inner_neighbors = inner_->GetNeighbors(inner_vertex, scratch);
+    if (inner_neighbors.data() != scratch->data())
+      scratch->assign(inner_neighbors.begin(), inner_neighbors.end());
+    for (VertexTy &n : *scratch)
+      n = Join(outer_vertex, n);
+    scratch->push_back(long_edge_neighbor);
+    return *scratch;
+  }
+
+  // The i'th vertex in the cloud of an outer vertex `o` is connected to the
+  // cloud of the i'th outer neighbor of `o`.
+  VertexTy GetLongEdgeNeighbor(VertexTy outer_vertex, VertexTy inner_vertex,
+                               std::vector<VertexTy> *scratch) {
+    auto outer_neighbors = outer_->GetNeighbors(outer_vertex, scratch);
+    assert(inner_vertex < outer_neighbors.size() &&
+           "Outer vertex must have degree equal to the number of vertices in "
+           "the inner graph!");
+    VertexTy other_outer_vertex = outer_neighbors[inner_vertex];
+
+    auto other_outer_neighbors =
+        outer_->GetNeighbors(other_outer_vertex, scratch);
+    auto it = std::find(other_outer_neighbors.begin(),
+                        other_outer_neighbors.end(), outer_vertex);
+    assert(it != other_outer_neighbors.end());
+    return Join(other_outer_vertex, it - other_outer_neighbors.begin());
+  }
+
+  // Every vertex keeps its inner edges and gains one long edge.
+  OrderTy GetDegree(VertexTy v) override {
+    return inner_->GetDegree(Split(v).second) + 1;
+  }
+
   OrderTy GetOrder() override {
     return outer_->GetOrder() * inner_->GetOrder();
   }
@@ -138,29 +150,30 @@ public:
     return outer * inner_->GetOrder() + inner;
   }
 
-  ReplacementProduct(std::unique_ptr<Graph> outer,
-                     std::unique_ptr<Graph> inner) {
+  ReplacementProduct(std::shared_ptr<Graph> outer,
+                     std::shared_ptr<Graph> inner) {
     outer_ = std::move(outer);
     inner_ = std::move(inner);
-    assert(IsRegular(outer_.get()).has_value());
   }
 
   Graph *GetOuter() { return outer_.get(); }
   Graph *GetInner() { return inner_.get(); }
 
+  // The operands are owned by the product alone, so nothing can mutate them
+  // and clones can share them.
   std::unique_ptr<Graph> Clone() override {
-    return std::make_unique<ReplacementProduct>(outer_->Clone(),
-                                                inner_->Clone());
+    return std::make_unique<ReplacementProduct>(outer_, inner_);
   }
 
 private:
-  std::unique_ptr<Graph> outer_;
-  std::unique_ptr<Graph> inner_;
+  std::shared_ptr<Graph> outer_;
+  std::shared_ptr<Graph> inner_;
 };
 } // namespace
 
 std::unique_ptr<Graph> CreateReplacementProduct(std::unique_ptr<Graph> outer,
                                                 std::unique_ptr<Graph> inner) {
+  assert(IsRegular(outer.get()) == inner->GetOrder());
   return std::make_unique<ReplacementProduct>(std::move(outer),
                                               std::move(inner));
 }
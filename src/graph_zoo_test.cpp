@@ -3,6 +3,7 @@
 
 #include "test.hpp"
 
+#include <algorithm>
 #include <set>
 
 using namespace kb;
@@ -171,6 +172,26 @@ static void TestReplacementProduct_Ring4_K2() {
   CHECK_EDGES_EQ(expected_edges, replacement_product);
 }
 
+static void TestReplacementProduct_GetNeighbors() {
+  auto replacement_product = CreateReplacementProduct(
+      CreateCompleteGraph(4, false), CreateRingGraph(3));
+
+  std::vector<Graph::VertexTy> scratch;
+  for (auto v : Iterate(replacement_product->GetVertices())) {
+    std::vector<Graph::VertexTy> expected_neighbors;
+    for (auto e : Iterate(replacement_product->GetEdgesContainingVertex(v))) {
+      CHECK_EQ(e.first, v);
+      expected_neighbors.push_back(e.second);
+    }
+
+    auto neighbors = replacement_product->GetNeighbors(v, &scratch);
+    CHECK_EQ(neighbors.size(), 3);
+    CHECK_EQ(replacement_product->GetDegree(v), 3);
+    CHECK(std::equal(neighbors.begin(), neighbors.end(),
+                     expected_neighbors.begin(), expected_neighbors.end()));
+  }
+}
+
 static void TestCreateRingGraph_4() {
   auto ring = CreateRingGraph(4);
 
@@ -204,6 +225,7 @@ static void TestCreateRingGraph_2() {
   F(TestCreateCompleteBipartiteGraph_1_5)                                      \
   F(TestCreateCompleteBipartiteGraph_5_1)                                      \
   F(TestReplacementProduct_Ring4_K2)                                           \
+  F(TestReplacementProduct_GetNeighbors)                                       \
   F(TestCreateRingGraph_4)                                                     \
   F(TestCreateRingGraph_2)                                                     \
   (void)0;
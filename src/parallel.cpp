@@ -0,0 +1,179 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace kb {
+static std::atomic<unsigned> DefaultConcurrencyOverride = 0;
+
+unsigned GetDefaultConcurrency() {
+  if (unsigned concurrency = DefaultConcurrencyOverride.load())
+    return concurrency;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void SetDefaultConcurrency(unsigned concurrency) {
+  DefaultConcurrencyOverride = concurrency;
+}
+
+unsigned GetTaskCount(size_t size, size_t min_grain) {
+  size_t tasks = size / std::max<size_t>(min_grain, 1);
+  return std::clamp<size_t>(tasks, 1, GetDefaultConcurrency());
+}
+
+void ParallelFor(size_t size, unsigned num_tasks,
+                 const std::function<void(unsigned, size_t, size_t)> &fn) {
+  num_tasks = std::max(num_tasks, 1u);
+  auto range_begin = [&](unsigned task) { return size * task / num_tasks; };
+
+  if (num_tasks == 1) {
+    fn(0, 0, size);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_tasks - 1);
+  for (unsigned task = 1; task < num_tasks; task++)
+    threads.emplace_back(fn, task, range_begin(task), range_begin(task + 1));
+
+  fn(0, 0, range_begin(1));
+  for (std::thread &t : threads)
+    t.join();
+}
+
+namespace {
+// Every deque has its own lock, and an atomic size so that thieves skip empty
+// deques without taking it.  Workers that find nothing to run sleep on a
+// condition variable until a task is pushed or the last one finishes, so idle
+// workers neither spin nor contend for the locks of busy ones.
+class WorkStealingQueue final : public TaskQueue {
+public:
+  explicit WorkStealingQueue(unsigned num_workers) : deques_(num_workers) {}
+
+  void Push(unsigned worker, Task task) override {
+    pending_++;
+    Deque &deque = deques_[worker];
+    {
+      std::lock_guard<std::mutex> lock(deque.mutex);
+      deque.tasks.push_back(std::move(task));
+      deque.size++;
+    }
+    // A worker that goes idle after this check sees the new task before it
+    // sleeps.
+    queued_++;
+    if (idle_workers_ != 0)
+      Wake(/*all=*/false);
+  }
+
+  bool HasIdleWorkers() const override {
+    return idle_workers_.load(std::memory_order_relaxed) != 0;
+  }
+
+  // Runs tasks until none are left anywhere.  A task is pending from when it
+  // is pushed until it returns, after pushing its own tasks, so no worker can
+  // see zero pending tasks while another may still push some.
+  void Work(unsigned worker) {
+    bool idle = false;
+    while (true) {
+      std::optional<Task> task = Pop(worker);
+      if (task) {
+        if (idle) {
+          idle_workers_--;
+          idle = false;
+        }
+        (*task)(worker, this);
+        if (--pending_ == 0)
+          Wake(/*all=*/true);
+        continue;
+      }
+
+      if (!idle) {
+        idle_workers_++;
+        idle = true;
+      }
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_.wait(lock, [&] { return queued_ != 0 || pending_ == 0; });
+      if (pending_ == 0)
+        break;
+    }
+    if (idle)
+      idle_workers_--;
+  }
+
+private:
+  struct alignas(64) Deque {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::atomic<size_t> size = 0;
+  };
+
+  // Taking the lock orders the notification after any waiter that checked
+  // the condition before the change has started waiting.
+  void Wake(bool all) {
+    { std::lock_guard<std::mutex> lock(wake_mutex_); }
+    if (all)
+      wake_.notify_all();
+    else
+      wake_.notify_one();
+  }
+
+  // Takes the newest task of `worker`, or else the oldest of the next worker
+  // that has any.
+  std::optional<Task> Pop(unsigned worker) {
+    if (queued_ == 0)
+      return std::nullopt;
+    for (unsigned i = 0, e = deques_.size(); i != e; i++) {
+      Deque &deque = deques_[(worker + i) % e];
+      if (deque.size == 0)
+        continue;
+      std::lock_guard<std::mutex> lock(deque.mutex);
+      if (deque.tasks.empty())
+        continue;
+      std::optional<Task> task;
+      if (i == 0) {
+        task = std::move(deque.tasks.back());
+        deque.tasks.pop_back();
+      } else {
+        task = std::move(deque.tasks.front());
+        deque.tasks.pop_front();
+      }
+      deque.size--;
+      queued_--;
+      return task;
+    }
+    return std::nullopt;
+  }
+
+  std::vector<Deque> deques_;
+  // Tasks pushed and not yet finished, and tasks waiting in the deques.
+  std::atomic<size_t> pending_ = 0;
+  std::atomic<size_t> queued_ = 0;
+  std::atomic<unsigned> idle_workers_ = 0;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+};
+} // namespace
+
+void RunWithWorkStealing(unsigned num_workers,
+                         std::vector<TaskQueue::Task> tasks) {
+  num_workers = std::max(num_workers, 1u);
+  WorkStealingQueue queue(num_workers);
+  for (size_t i = 0; i != tasks.size(); i++)
+    queue.Push(i % num_workers, std::move(tasks[i]));
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers - 1);
+  for (unsigned worker = 1; worker < num_workers; worker++)
+    threads.emplace_back([&queue, worker] { queue.Work(worker); });
+  queue.Work(0);
+  for (std::thread &t : threads)
+    t.join();
+}
+} // namespace kb
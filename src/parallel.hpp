@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace kb {
+// The number of worker threads parallel algorithms use by default.  This is
+// the hardware concurrency unless overridden with SetDefaultConcurrency.
+unsigned GetDefaultConcurrency();
+
+// Overrides GetDefaultConcurrency; passing 0 restores the hardware default.
+void SetDefaultConcurrency(unsigned concurrency);
+
+// Returns how many tasks to split `size` units of work into so that each task
+// gets at least `min_grain` units, capped at GetDefaultConcurrency().
+unsigned GetTaskCount(size_t size, size_t min_grain);
+
+// Splits [0, size) into `num_tasks` contiguous ranges and calls
+// `fn(task, begin, end)` for each of them, concurrently.  Returns once every
+// call has finished.  Runs inline on the calling thread if `num_tasks` is 1.
+void ParallelFor(size_t size, unsigned num_tasks,
+                 const std::function<void(unsigned, size_t, size_t)> &fn);
+
+// Lets the tasks run by RunWithWorkStealing hand work to other threads.
+class TaskQueue {
+public:
+  // Gets the index of the worker running it, below the number of workers, so
+  // that it can use per-worker state.
+  using Task = std::function<void(unsigned worker, TaskQueue *queue)>;
+
+  // Queues `task` on the deque of `worker`, which must be the worker running
+  // the caller.
+  virtual void Push(unsigned worker, Task task) = 0;
+
+  // Whether some worker has run out of tasks.  Recursive searches can check
+  // this to decide whether to split off a subtree.
+  virtual bool HasIdleWorkers() const = 0;
+
+protected:
+  ~TaskQueue() = default;
+};
+
+// Runs `tasks`, and every task they push, on `num_workers` threads including
+// the calling one.  Each worker runs the newest task of its own deque and, once
+// that is empty, steals the oldest task of another worker's, which for a
+// recursive search is the largest subtree split off.  Returns once every task
+// has finished.
+void RunWithWorkStealing(unsigned num_workers,
+                         std::vector<TaskQueue::Task> tasks);
+} // namespace kb
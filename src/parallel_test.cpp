@@ -0,0 +1,81 @@
+#include "parallel.hpp"
+#include "test.hpp"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+using namespace kb;
+
+static void TestParallelFor_CoversRange() {
+  std::vector<std::atomic<int>> visits(1000);
+  std::vector<std::atomic<int>> tasks_run(7);
+  ParallelFor(visits.size(), 7, [&](unsigned task, size_t begin, size_t end) {
+    tasks_run[task]++;
+    for (size_t i = begin; i != end; i++)
+      visits[i]++;
+  });
+
+  for (auto &v : visits)
+    CHECK_EQ(v.load(), 1);
+  for (auto &t : tasks_run)
+    CHECK_EQ(t.load(), 1);
+}
+
+static void TestParallelFor_EmptyRange() {
+  int calls = 0;
+  ParallelFor(0, 1, [&](unsigned, size_t begin, size_t end) {
+    calls++;
+    CHECK_EQ(begin, end);
+  });
+  CHECK_EQ(calls, 1);
+}
+
+static void TestGetTaskCount() {
+  SetDefaultConcurrency(8);
+  CHECK_EQ(GetTaskCount(0, 100), 1);
+  CHECK_EQ(GetTaskCount(250, 100), 2);
+  CHECK_EQ(GetTaskCount(100000, 100), 8);
+  SetDefaultConcurrency(0);
+  CHECK_GE(GetDefaultConcurrency(), 1);
+}
+
+// Counts the nodes of a complete binary tree of depth 12, each node a task
+// that pushes its children.
+static void TestRunWithWorkStealing() {
+  for (unsigned num_workers : {1, 4}) {
+    std::vector<std::atomic<int>> nodes_by_worker(num_workers);
+    std::function<void(int, unsigned, TaskQueue *)> visit =
+        [&](int depth, unsigned worker, TaskQueue *queue) {
+          CHECK_LT(worker, num_workers);
+          nodes_by_worker[worker]++;
+          if (depth == 12)
+            return;
+          for (int child = 0; child < 2; child++)
+            queue->Push(worker, [&, depth](unsigned worker, TaskQueue *queue) {
+              visit(depth + 1, worker, queue);
+            });
+        };
+
+    std::vector<TaskQueue::Task> roots;
+    for (int root = 0; root < 3; root++)
+      roots.push_back([&](unsigned worker, TaskQueue *queue) {
+        visit(0, worker, queue);
+      });
+    RunWithWorkStealing(num_workers, std::move(roots));
+
+    int nodes = 0;
+    for (auto &n : nodes_by_worker)
+      nodes += n.load();
+    CHECK_EQ(nodes, 3 * ((1 << 13) - 1));
+  }
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestParallelFor_CoversRange)                                               \
+  F(TestParallelFor_EmptyRange)                                                \
+  F(TestGetTaskCount)                                                          \
+  F(TestRunWithWorkStealing)                                                   \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)
@@ -0,0 +1,724 @@
+#include "spectral.hpp"
+
+#include "graph_view.hpp"
+#include "logging.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+namespace kb {
+namespace {
+// Below this many vector entries per task, vector operations and
+// matrix-vector products are not worth spreading over multiple threads.
+constexpr size_t kVectorGrain = 1 << 15;
+
+// A residual below this, relative to the largest Ritz value, means the basis
+// spans an invariant subspace.
+constexpr double kBreakdownTolerance = 1e-12;
+
+// Adjacency copied out of graphs that do not store it in CSR form.
+struct FlatAdjacency {
+  std::vector<size_t> offsets;
+  std::vector<Graph::VertexTy> neighbors;
+};
+
+FlatAdjacency FlattenAdjacency(Graph *g) {
+  Graph::OrderTy order = g->GetOrder();
+  FlatAdjacency result;
+  result.offsets.assign(order + 1, 0);
+  for (Graph::VertexTy v = 0; v != order; v++)
+    result.offsets[v + 1] = result.offsets[v] + g->GetDegree(v);
+
+  result.neighbors.resize(result.offsets.back());
+  unsigned tasks = GetTaskCount(result.neighbors.size(), kVectorGrain);
+  ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+    std::vector<Graph::VertexTy> scratch;
+    for (Graph::VertexTy v = begin; v != end; v++) {
+      auto neighbors = g->GetNeighbors(v, &scratch);
+      std::copy(neighbors.begin(), neighbors.end(),
+                result.neighbors.begin() + result.offsets[v]);
+    }
+  });
+  return result;
+}
+
+// Calls `fn(view)` with a CSR view of `g`, copying the adjacency if `g` does
+// not have one.
+template <typename Fn> auto VisitCsrView(Graph *g, Fn fn) {
+  if (const CsrGraphView<CompactVertexTy> *view = g->GetCompactCsrView())
+    return fn(*view);
+  if (const CsrGraphView<Graph::VertexTy> *view = g->GetWideCsrView())
+    return fn(*view);
+  FlatAdjacency adjacency = FlattenAdjacency(g);
+  return fn(CsrGraphView<Graph::VertexTy>(adjacency.offsets,
+                                          adjacency.neighbors));
+}
+
+double Dot(std::span<const double> a, std::span<const double> b) {
+  unsigned tasks = GetTaskCount(a.size(), kVectorGrain);
+  std::vector<double> partial_sums(tasks, 0);
+  ParallelFor(a.size(), tasks, [&](unsigned task, size_t begin, size_t end) {
+    double sum = 0;
+    for (size_t i = begin; i != end; i++)
+      sum += a[i] * b[i];
+    partial_sums[task] = sum;
+  });
+  return std::accumulate(partial_sums.begin(), partial_sums.end(), 0.0);
+}
+
+void Scale(double factor, std::span<double> a) {
+  unsigned tasks = GetTaskCount(a.size(), kVectorGrain);
+  ParallelFor(a.size(), tasks, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i != end; i++)
+      a[i] *= factor;
+  });
+}
+
+// The vectors of the Krylov basis, stored one after the other.
+class Basis {
+public:
+  Basis(size_t dimension, size_t size)
+      : size_(size), vectors_(dimension * size) {}
+
+  std::span<double> operator[](size_t i) {
+    return std::span(vectors_).subspan(i * size_, size_);
+  }
+
+  // Makes `w` orthogonal to the first `count` vectors, which must be
+  // orthonormal, and adds the coefficients removed to `coefficients`.
+  // Classical Gram-Schmidt, run by the caller twice for stability.
+  void ProjectOut(size_t count, std::span<double> w,
+                  std::vector<double> *coefficients) {
+    unsigned tasks = GetTaskCount(size_ * count, kVectorGrain);
+    std::vector<double> partial_sums(tasks * count, 0);
+    ParallelFor(size_, tasks, [&](unsigned task, size_t begin, size_t end) {
+      for (size_t l = 0; l != count; l++) {
+        std::span<const double> v = (*this)[l];
+        double sum = 0;
+        for (size_t i = begin; i != end; i++)
+          sum += v[i] * w[i];
+        partial_sums[task * count + l] = sum;
+      }
+    });
+
+    std::vector<double> projection(count, 0);
+    for (unsigned task = 0; task != tasks; task++)
+      for (size_t l = 0; l != count; l++)
+        projection[l] += partial_sums[task * count + l];
+
+    ParallelFor(size_, tasks, [&](unsigned, size_t begin, size_t end) {
+      for (size_t l = 0; l != count; l++) {
+        std::span<const double> v = (*this)[l];
+        for (size_t i = begin; i != end; i++)
+          w[i] -= projection[l] * v[i];
+      }
+    });
+
+    for (size_t l = 0; l != count; l++)
+      (*coefficients)[l] += projection[l];
+  }
+
+  // Sets `out` to the combination of the first `count` vectors with weights
+  // `weights`.
+  void Combine(size_t count, std::span<const double> weights,
+               std::span<double> out) {
+    unsigned tasks = GetTaskCount(size_ * count, kVectorGrain);
+    ParallelFor(size_, tasks, [&](unsigned, size_t begin, size_t end) {
+      std::fill(out.begin() + begin, out.begin() + end, 0.0);
+      for (size_t l = 0; l != count; l++) {
+        std::span<const double> v = (*this)[l];
+        for (size_t i = begin; i != end; i++)
+          out[i] += weights[l] * v[i];
+      }
+    });
+  }
+
+  void Swap(Basis &other) { vectors_.swap(other.vectors_); }
+
+private:
+  size_t size_;
+  std::vector<double> vectors_;
+};
+
+// Diagonalizes the symmetric `size` x `size` row major matrix `a` with cyclic
+// Jacobi rotations.  Returns the eigenvalues in descending order, and the
+// matching eigenvectors as the columns of `vectors`.
+std::vector<double> DiagonalizeSymmetric(std::vector<double> a, size_t size,
+                                         std::vector<double> *vectors) {
+  std::vector<double> v(size * size, 0);
+  for (size_t i = 0; i != size; i++)
+    v[i * size + i] = 1;
+
+  for (unsigned sweep = 0; sweep != 100; sweep++) {
+    double off_diagonal = 0;
+    double total = 0;
+    for (size_t p = 0; p != size; p++) {
+      for (size_t q = 0; q != size; q++) {
+        total += a[p * size + q] * a[p * size + q];
+        if (p != q)
+          off_diagonal += a[p * size + q] * a[p * size + q];
+      }
+    }
+    if (off_diagonal <= 1e-30 * total)
+      break;
+
+    for (size_t p = 0; p + 1 < size; p++) {
+      for (size_t q = p + 1; q != size; q++) {
+        double apq = a[p * size + q];
+        if (apq == 0)
+          continue;
+        double theta = (a[q * size + q] - a[p * size + p]) / (2 * apq);
+        double t = (theta >= 0 ? 1.0 : -1.0) /
+                   (std::abs(theta) + std::sqrt(theta * theta + 1));
+        double c = 1 / std::sqrt(t * t + 1);
+        double s = t * c;
+        for (size_t k = 0; k != size; k++) {
+          double akp = a[k * size + p], akq = a[k * size + q];
+          a[k * size + p] = c * akp - s * akq;
+          a[k * size + q] = s * akp + c * akq;
+        }
+        for (size_t k = 0; k != size; k++) {
+          double apk = a[p * size + k], aqk = a[q * size + k];
+          a[p * size + k] = c * apk - s * aqk;
+          a[q * size + k] = s * apk + c * aqk;
+        }
+        for (size_t k = 0; k != size; k++) {
+          double vkp = v[k * size + p], vkq = v[k * size + q];
+          v[k * size + p] = c * vkp - s * vkq;
+          v[k * size + q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+
+  std::vector<size_t> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+    return a[x * size + x] > a[y * size + y];
+  });
+  std::vector<double> values(size);
+  vectors->assign(size * size, 0);
+  for (size_t j = 0; j != size; j++) {
+    values[j] = a[order[j] * size + order[j]];
+    for (size_t k = 0; k != size; k++)
+      (*vectors)[k * size + j] = v[k * size + order[j]];
+  }
+  return values;
+}
+
+// The matrix M = S A S, where S is the identity for the adjacency matrix and
+// D^-1/2 for the normalized Laplacian, whose eigenvalues are 1 minus those of
+// M.
+template <typename IndexTy> class SymmetricOperator {
+public:
+  SymmetricOperator(const CsrGraphView<IndexTy> &view, bool normalized)
+      : view_(view) {
+    if (!normalized)
+      return;
+    scale_.resize(view.GetOrder());
+    for (Graph::VertexTy v = 0, e = view.GetOrder(); v != e; v++) {
+      Graph::OrderTy degree = view.GetDegree(v);
+      scale_[v] = degree == 0 ? 0 : 1 / std::sqrt(static_cast<double>(degree));
+    }
+    scaled_input_.resize(view.GetOrder());
+  }
+
+  void Multiply(std::span<const double> x, std::span<double> y) {
+    Graph::OrderTy order = view_.GetOrder();
+    unsigned tasks = GetTaskCount(order + view_.GetNeighborArray().size(),
+                                  kVectorGrain);
+    std::span<const double> input = x;
+    if (!scale_.empty()) {
+      ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i != end; i++)
+          scaled_input_[i] = scale_[i] * x[i];
+      });
+      input = scaled_input_;
+    }
+
+    ParallelFor(order, tasks, [&](unsigned, size_t begin, size_t end) {
+      for (Graph::VertexTy v = begin; v != end; v++) {
+        // Independent partial sums let the compiler interleave the loads.
+        std::span<const IndexTy> neighbors = view_.GetNeighbors(v);
+        double sums[4] = {0, 0, 0, 0};
+        size_t i = 0;
+        for (size_t e = neighbors.size() & ~size_t(3); i != e; i += 4)
+          for (size_t lane = 0; lane != 4; lane++)
+            sums[lane] += input[neighbors[i + lane]];
+        for (; i != neighbors.size(); i++)
+          sums[0] += input[neighbors[i]];
+        double sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        y[v] = scale_.empty() ? sum : scale_[v] * sum;
+      }
+    });
+  }
+
+  // For the normalized Laplacian, the eigenvector of M with eigenvalue 1,
+  // D^1/2 1 normalized, or an empty vector if the graph has no edges.
+  std::vector<double> GetTopEigenvector() const {
+    if (scale_.empty() || view_.GetNeighborArray().empty())
+      return {};
+    std::vector<double> result(view_.GetOrder());
+    for (Graph::VertexTy v = 0, e = view_.GetOrder(); v != e; v++)
+      result[v] = std::sqrt(static_cast<double>(view_.GetDegree(v)));
+    Scale(1 / std::sqrt(Dot(result, result)), result);
+    return result;
+  }
+
+private:
+  const CsrGraphView<IndexTy> &view_;
+  std::vector<double> scale_;
+  std::vector<double> scaled_input_;
+};
+
+// Finds the `count` largest eigenpairs of `op` on the orthogonal complement of
+// the unit vector `deflation`, if it is not empty.
+template <typename IndexTy>
+Spectrum ComputeLargestEigenpairs(SymmetricOperator<IndexTy> *op,
+                                  Graph::OrderTy order,
+                                  std::span<const double> deflation,
+                                  unsigned count,
+                                  const SpectrumOptions &options) {
+  Spectrum result;
+  size_t space = order - (deflation.empty() ? 0 : 1);
+  count = std::min<size_t>(count, space);
+  if (count == 0) {
+    result.converged = true;
+    return result;
+  }
+
+  // The basis needs room beyond the wanted vectors to make progress between
+  // restarts, unless it spans the whole space.
+  size_t dimension = std::min<size_t>(
+      std::max<size_t>(options.krylov_dimension, count + 1), space);
+  Basis basis(dimension, order), next_basis(dimension, order);
+  std::vector<double> w(order);
+  auto deflate = [&](std::span<double> v) {
+    if (!deflation.empty()) {
+      double projection = Dot(deflation, v);
+      for (size_t i = 0; i != order; i++)
+        v[i] -= projection * deflation[i];
+    }
+  };
+
+  std::mt19937_64 rng(options.seed);
+  std::uniform_real_distribution<double> distribution(-1, 1);
+  for (double &x : basis[0])
+    x = distribution(rng);
+  deflate(basis[0]);
+  Scale(1 / std::sqrt(Dot(basis[0], basis[0])), basis[0]);
+
+  // `projected` is the matrix of `op` restricted to the basis.  Vectors below
+  // `kept` are Ritz vectors kept from the previous restart.
+  std::vector<double> projected(dimension * dimension, 0);
+  std::vector<double> ritz_values, ritz_vectors;
+  std::vector<double> coefficients(dimension);
+  size_t kept = 0;
+  size_t active = dimension;
+  double residual_norm = 0;
+  for (unsigned restart = 0;; restart++) {
+    active = dimension;
+    for (size_t i = kept; i != dimension; i++) {
+      op->Multiply(basis[i], w);
+      deflate(w);
+      std::fill(coefficients.begin(), coefficients.end(), 0.0);
+      basis.ProjectOut(i + 1, w, &coefficients);
+      basis.ProjectOut(i + 1, w, &coefficients);
+      for (size_t l = 0; l <= i; l++) {
+        projected[l * dimension + i] = coefficients[l];
+        projected[i * dimension + l] = coefficients[l];
+      }
+
+      residual_norm = std::sqrt(Dot(w, w));
+      double scale = std::abs(projected[i * dimension + i]) + 1;
+      if (residual_norm <= kBreakdownTolerance * scale) {
+        residual_norm = 0;
+        active = i + 1;
+        break;
+      }
+      if (i + 1 != dimension) {
+        std::copy(w.begin(), w.end(), basis[i + 1].begin());
+        Scale(1 / residual_norm, basis[i + 1]);
+      }
+    }
+
+    std::vector<double> active_projected(active * active);
+    for (size_t r = 0; r != active; r++)
+      for (size_t c = 0; c != active; c++)
+        active_projected[r * active + c] = projected[r * dimension + c];
+    ritz_values = DiagonalizeSymmetric(active_projected, active, &ritz_vectors);
+
+    count = std::min<size_t>(count, active);
+    result.residuals.assign(count, 0);
+    result.converged = true;
+    for (size_t j = 0; j != count; j++) {
+      result.residuals[j] =
+          residual_norm * std::abs(ritz_vectors[(active - 1) * active + j]);
+      if (result.residuals[j] > options.tolerance)
+        result.converged = false;
+    }
+    if (result.converged || restart == options.max_restarts)
+      break;
+
+    // Thick restart: keep the best Ritz vectors, followed by the residual,
+    // which is orthogonal to all of them.
+    kept = std::min(dimension - 1, count + (dimension - count) / 2);
+    std::vector<double> weights(active);
+    for (size_t j = 0; j != kept; j++) {
+      for (size_t l = 0; l != active; l++)
+        weights[l] = ritz_vectors[l * active + j];
+      basis.Combine(active, weights, next_basis[j]);
+    }
+    basis.Swap(next_basis);
+    std::copy(w.begin(), w.end(), basis[kept].begin());
+    Scale(1 / residual_norm, basis[kept]);
+    std::fill(projected.begin(), projected.end(), 0.0);
+    for (size_t j = 0; j != kept; j++)
+      projected[j * dimension + j] = ritz_values[j];
+  }
+
+  LOG_VAR(result.converged);
+  std::vector<double> weights(active);
+  for (size_t j = 0; j != count; j++) {
+    result.eigenvalues.push_back(ritz_values[j]);
+    for (size_t l = 0; l != active; l++)
+      weights[l] = ritz_vectors[l * active + j];
+    std::vector<double> &eigenvector = result.eigenvectors.emplace_back(order);
+    basis.Combine(active, weights, eigenvector);
+  }
+  return result;
+}
+
+template <typename IndexTy>
+Spectrum ComputeSpectrum(const CsrGraphView<IndexTy> &view,
+                         const SpectrumOptions &options) {
+  Graph::OrderTy order = view.GetOrder();
+  if (options.matrix == SpectralMatrix::kAdjacency) {
+    SymmetricOperator<IndexTy> op(view, /*normalized=*/false);
+    return ComputeLargestEigenpairs(&op, order, {}, options.eigenvalue_count,
+                                    options);
+  }
+
+  // The smallest eigenvalue of the normalized Laplacian is 0, with a known
+  // eigenvector, so the solver looks for the others orthogonally to it.
+  SymmetricOperator<IndexTy> op(view, /*normalized=*/true);
+  std::vector<double> top = op.GetTopEigenvector();
+  unsigned remaining = options.eigenvalue_count;
+  if (!top.empty() && remaining != 0)
+    remaining--;
+  Spectrum result =
+      ComputeLargestEigenpairs(&op, order, top, remaining, options);
+  for (double &eigenvalue : result.eigenvalues)
+    eigenvalue = 1 - eigenvalue;
+  if (!top.empty() && options.eigenvalue_count != 0) {
+    result.eigenvalues.insert(result.eigenvalues.begin(), 0);
+    result.eigenvectors.insert(result.eigenvectors.begin(), std::move(top));
+    result.residuals.insert(result.residuals.begin(), 0);
+  }
+  return result;
+}
+
+// Returns the set, among the prefixes of `order` and of its reverse with at
+// most half the vertices, with the least ratio of boundary to size.
+template <typename IndexTy>
+std::vector<Graph::VertexTy>
+FindBestSweepSet(const CsrGraphView<IndexTy> &view,
+                 const std::vector<Graph::VertexTy> &order,
+                 Graph::OrderTy *best_boundary) {
+  Graph::OrderTy vertex_count = view.GetOrder();
+  Graph::OrderTy half = vertex_count / 2;
+  Graph::OrderTy best_size = 0;
+  bool best_reverse = false;
+  *best_boundary = 0;
+
+  std::vector<Graph::OrderTy> neighbors_in_set(vertex_count);
+  std::vector<char> in_set(vertex_count);
+  for (bool reverse : {false, true}) {
+    std::fill(neighbors_in_set.begin(), neighbors_in_set.end(), 0);
+    std::fill(in_set.begin(), in_set.end(), false);
+    Graph::OrderTy boundary = 0;
+    for (Graph::OrderTy size = 1; size <= half; size++) {
+      Graph::VertexTy v =
+          reverse ? order[vertex_count - size] : order[size - 1];
+      if (neighbors_in_set[v] != 0)
+        boundary--;
+      in_set[v] = true;
+      for (Graph::VertexTy n : view.GetNeighbors(v))
+        if (neighbors_in_set[n]++ == 0 && !in_set[n])
+          boundary++;
+
+      if (best_size == 0 || boundary * best_size < *best_boundary * size) {
+        *best_boundary = boundary;
+        best_size = size;
+        best_reverse = reverse;
+      }
+    }
+  }
+
+  std::vector<Graph::VertexTy> best_set;
+  for (Graph::OrderTy i = 1; i <= best_size; i++)
+    best_set.push_back(best_reverse ? order[vertex_count - i] : order[i - 1]);
+  std::sort(best_set.begin(), best_set.end());
+  return best_set;
+}
+
+template <typename IndexTy>
+SpectralExpansionBounds
+ComputeSpectralExpansionBounds(const CsrGraphView<IndexTy> &view,
+                               const SpectrumOptions &options) {
+  SpectralExpansionBounds bounds;
+  Graph::OrderTy vertex_count = view.GetOrder();
+  if (vertex_count < 2) {
+    bounds.converged = true;
+    return bounds;
+  }
+
+  Graph::OrderTy min_degree = view.GetDegree(0), max_degree = 0;
+  for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+    min_degree = std::min(min_degree, view.GetDegree(v));
+    max_degree = std::max(max_degree, view.GetDegree(v));
+  }
+
+  // An isolated vertex is a set with an empty boundary.
+  if (min_degree == 0) {
+    for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+      if (view.GetDegree(v) == 0) {
+        bounds.sweep_set.push_back(v);
+        break;
+      }
+    }
+    bounds.cheeger_upper_bound = 0;
+    bounds.converged = true;
+    return bounds;
+  }
+
+  SpectrumOptions spectrum_options = options;
+  spectrum_options.matrix = SpectralMatrix::kNormalizedLaplacian;
+  spectrum_options.eigenvalue_count = 2;
+  Spectrum spectrum = ComputeSpectrum(view, spectrum_options);
+  bounds.converged = spectrum.converged;
+  bounds.spectral_gap = spectrum.eigenvalues[1];
+
+  // Without convergence the gap is too rough to estimate from.
+  if (spectrum.converged) {
+    double gap = std::max(0.0, bounds.spectral_gap - spectrum.residuals[1]);
+    bounds.cheeger_lower_estimate = gap * min_degree / (2.0 * max_degree);
+  }
+
+  // Sweep over the Fiedler vector scaled back by D^-1/2, which is the
+  // eigenvector of the random walk Laplacian.
+  const std::vector<double> &fiedler = spectrum.eigenvectors[1];
+  std::vector<double> scaled(vertex_count);
+  for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+    scaled[v] = fiedler[v] / std::sqrt(view.GetDegree(v));
+  }
+  std::vector<Graph::VertexTy> order(vertex_count);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](Graph::VertexTy a, Graph::VertexTy b) {
+                     return scaled[a] < scaled[b];
+                   });
+
+  Graph::OrderTy boundary;
+  bounds.sweep_set = FindBestSweepSet(view, order, &boundary);
+  bounds.cheeger_upper_bound =
+      static_cast<double>(boundary) / bounds.sweep_set.size();
+  return bounds;
+}
+
+// The per-thread state of FindLocalCluster.  Only the vertices a run touches
+// have state, kept in a hash map that is emptied after the run, so a run
+// costs time and memory proportional to the part of the graph it explores.
+template <typename IndexTy> class LocalClusterSearch {
+public:
+  LocalClusterSearch(const CsrGraphView<IndexTy> &view,
+                     const LocalClusterOptions &options)
+      : view_(view), options_(options) {}
+
+  // Replaces `*best` by the best sweep set around `seed` if it is better.
+  void Run(Graph::VertexTy seed, LocalCluster *best) {
+    Push(seed);
+    Sweep(seed, best);
+    states_.clear();
+  }
+
+private:
+  struct VertexState {
+    double probability = 0;
+    double residual = 0;
+    Graph::OrderTy neighbors_in_set = 0;
+    bool queued = false;
+    bool in_set = false;
+  };
+
+  // Pushes until every vertex holds less than epsilon times its degree in
+  // residual probability.  A push keeps alpha of the residual, leaves half of
+  // the rest in place and spreads the other half over the neighbors, which
+  // is a step of the lazy random walk.
+  void Push(Graph::VertexTy seed) {
+    states_[seed] = {.residual = 1, .queued = true};
+    queue_.assign(1, seed);
+    for (size_t head = 0; head != queue_.size(); head++) {
+      Graph::VertexTy u = queue_[head];
+      Graph::OrderTy degree = view_.GetDegree(u);
+      double share;
+      {
+        // References into the map do not survive the insertions below.
+        VertexState &state = states_[u];
+        state.queued = false;
+        double mass = state.residual;
+        state.probability += options_.alpha * mass;
+        state.residual = (1 - options_.alpha) * mass / 2;
+        share = state.residual / degree;
+      }
+      for (Graph::VertexTy n : view_.GetNeighbors(u)) {
+        VertexState &state = states_[n];
+        state.residual += share;
+        if (!state.queued &&
+            state.residual >= options_.epsilon * view_.GetDegree(n)) {
+          state.queued = true;
+          queue_.push_back(n);
+        }
+      }
+      VertexState &state = states_[u];
+      if (!state.queued && state.residual >= options_.epsilon * degree) {
+        state.queued = true;
+        queue_.push_back(u);
+      }
+    }
+  }
+
+  void Sweep(Graph::VertexTy seed, LocalCluster *best) {
+    // Sort by probability per unit degree, breaking ties by vertex so that
+    // the order does not depend on the hash map.
+    sorted_.clear();
+    for (const auto &[v, state] : states_)
+      if (state.probability > 0)
+        sorted_.push_back({state.probability / view_.GetDegree(v), v});
+    std::sort(sorted_.begin(), sorted_.end(),
+              [](const auto &a, const auto &b) {
+                return a.first != b.first ? a.first > b.first
+                                          : a.second < b.second;
+              });
+    sorted_.resize(std::min<size_t>(sorted_.size(), view_.GetOrder() / 2));
+
+    // Every neighbor of a vertex with probability was pushed to, so it
+    // already has state.
+    Graph::OrderTy boundary = 0, best_size = 0, best_boundary = 0;
+    for (Graph::OrderTy size = 1; size <= sorted_.size(); size++) {
+      Graph::VertexTy v = sorted_[size - 1].second;
+      VertexState &state = states_[v];
+      if (state.neighbors_in_set != 0)
+        boundary--;
+      state.in_set = true;
+      for (Graph::VertexTy n : view_.GetNeighbors(v)) {
+        VertexState &neighbor = states_[n];
+        if (neighbor.neighbors_in_set++ == 0 && !neighbor.in_set)
+          boundary++;
+      }
+
+      if (best_size == 0 || boundary * best_size < best_boundary * size) {
+        best_boundary = boundary;
+        best_size = size;
+      }
+    }
+
+    if (best_size == 0 ||
+        (!best->set.empty() &&
+         best_boundary * best->set.size() >= best->boundary_size * best_size))
+      return;
+    best->set.clear();
+    for (Graph::OrderTy i = 0; i != best_size; i++)
+      best->set.push_back(sorted_[i].second);
+    std::sort(best->set.begin(), best->set.end());
+    best->boundary_size = best_boundary;
+    best->cheeger_upper_bound = static_cast<double>(best_boundary) / best_size;
+    best->seed_vertex = seed;
+  }
+
+  const CsrGraphView<IndexTy> &view_;
+  const LocalClusterOptions &options_;
+  std::unordered_map<Graph::VertexTy, VertexState> states_;
+  std::vector<Graph::VertexTy> queue_;
+  std::vector<std::pair<double, Graph::VertexTy>> sorted_;
+};
+
+template <typename IndexTy>
+LocalCluster FindLocalCluster(const CsrGraphView<IndexTy> &view,
+                              const LocalClusterOptions &options) {
+  LocalCluster result;
+  Graph::OrderTy vertex_count = view.GetOrder();
+  if (vertex_count < 2)
+    return result;
+
+  // An isolated vertex is a set with an empty boundary, and cannot be pushed
+  // from.
+  for (Graph::VertexTy v = 0; v != vertex_count; v++) {
+    if (view.GetDegree(v) == 0) {
+      result.set = {v};
+      result.cheeger_upper_bound = 0;
+      result.seed_vertex = v;
+      return result;
+    }
+  }
+
+  std::vector<Graph::VertexTy> seeds;
+  if (options.seed_count >= vertex_count) {
+    seeds.resize(vertex_count);
+    std::iota(seeds.begin(), seeds.end(), 0);
+  } else {
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<Graph::VertexTy> distribution(
+        0, vertex_count - 1);
+    for (Graph::OrderTy i = 0; i != options.seed_count; i++)
+      seeds.push_back(distribution(rng));
+  }
+
+  // Seeds are taken in order within a task, and ties between tasks go to the
+  // earlier one, so the result does not depend on the number of threads.
+  unsigned tasks = GetTaskCount(seeds.size(), 1);
+  std::vector<LocalCluster> task_results(tasks);
+  auto search_seeds = [&](unsigned task, size_t begin, size_t end) {
+    LocalClusterSearch<IndexTy> search(view, options);
+    for (size_t i = begin; i != end; i++)
+      search.Run(seeds[i], &task_results[task]);
+  };
+  ParallelFor(seeds.size(), tasks, search_seeds);
+  for (LocalCluster &task_result : task_results) {
+    if (task_result.set.empty())
+      continue;
+    if (result.set.empty() ||
+        task_result.boundary_size * result.set.size() <
+            result.boundary_size * task_result.set.size())
+      result = std::move(task_result);
+  }
+  LOG_VAR(result.set.size());
+  LOG_VAR(result.boundary_size);
+  return result;
+}
+} // namespace
+
+Spectrum ComputeSpectrum(Graph *g, const SpectrumOptions &options) {
+  return VisitCsrView(
+      g, [&](const auto &view) { return ComputeSpectrum(view, options); });
+}
+
+SpectralExpansionBounds
+ComputeSpectralExpansionBounds(Graph *g, const SpectrumOptions &options) {
+  return VisitCsrView(g, [&](const auto &view) {
+    return ComputeSpectralExpansionBounds(view, options);
+  });
+}
+
+LocalCluster FindLocalCluster(Graph *g, const LocalClusterOptions &options) {
+  return VisitCsrView(
+      g, [&](const auto &view) { return FindLocalCluster(view, options); });
+}
+} // namespace kb
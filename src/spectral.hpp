@@ -0,0 +1,121 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <limits>
+#include <vector>
+
+namespace kb {
+enum class SpectralMatrix {
+  // The adjacency matrix A, a self loop adding one to the diagonal.
+  kAdjacency,
+  // I - D^-1/2 A D^-1/2, where D is the diagonal matrix of degrees.  Its
+  // eigenvalues lie in [0, 2] and the smallest one is 0.  Isolated vertices
+  // have a zero row in D^-1/2 A D^-1/2.
+  kNormalizedLaplacian,
+};
+
+struct SpectrumOptions {
+  SpectralMatrix matrix = SpectralMatrix::kAdjacency;
+
+  // How many eigenvalues to compute: the largest ones of the adjacency
+  // matrix, or the smallest ones of the normalized Laplacian.
+  unsigned eigenvalue_count = 2;
+
+  // The number of basis vectors the solver keeps, each one double per vertex.
+  // Larger bases need fewer restarts.
+  unsigned krylov_dimension = 24;
+
+  unsigned max_restarts = 500;
+
+  // An eigenpair has converged once its residual norm is below this.
+  double tolerance = 1e-8;
+
+  unsigned seed = 1;
+};
+
+struct Spectrum {
+  // From the largest for the adjacency matrix, from the smallest for the
+  // normalized Laplacian.
+  std::vector<double> eigenvalues;
+
+  // Unit eigenvectors and the residual norms |Mx - λx| of the eigenpairs.
+  std::vector<std::vector<double>> eigenvectors;
+  std::vector<double> residuals;
+
+  bool converged = false;
+};
+
+// Computes extreme eigenpairs with a thick restarted Lanczos iteration over a
+// multithreaded sparse matrix-vector product.  The product walks the graph in
+// vertex order, so graphs reordered for locality (see graph_reorder.hpp) run
+// faster.  Like any single vector Krylov method, it finds each eigenvalue once
+// even if its multiplicity is higher.
+Spectrum ComputeSpectrum(Graph *g, const SpectrumOptions &options = {});
+
+struct SpectralExpansionBounds {
+  // The second smallest eigenvalue of the normalized Laplacian, which is zero
+  // exactly if the graph is disconnected.  Zero without running the solver if
+  // the graph has an isolated vertex.
+  double spectral_gap = 0;
+
+  // Estimates the Cheeger constant, as ComputeExactCheegerConstant defines
+  // it, from below through the Cheeger inequality: the edges leaving a set S,
+  // or its complement if that has less volume, number at least gap / 2 times
+  // its volume, which is at least min degree * |S|, and each boundary vertex
+  // takes at most max degree of them.  So |∂S| / |S| >= gap * min degree /
+  // (2 * max degree), the gap being lowered by its residual norm.  This is
+  // not certified: convergence only means the Ritz pairs found have small
+  // residuals, and Lanczos can miss an eigenvalue whose eigenvector is
+  // orthogonal to its start vector.  Zero if the solver did not converge.
+  double cheeger_lower_estimate = 0;
+
+  // An upper bound on the Cheeger constant, attained by `sweep_set`, the best
+  // set of vertices with the lowest or highest entries of the scaled Fiedler
+  // vector.
+  double cheeger_upper_bound = std::numeric_limits<double>::infinity();
+  std::vector<Graph::VertexTy> sweep_set;
+
+  bool converged = false;
+};
+
+// Computes the spectral gap of the normalized Laplacian and the bounds above,
+// in time linear in the size of the graph per solver iteration.
+// `options.matrix` and `options.eigenvalue_count` are ignored.
+SpectralExpansionBounds
+ComputeSpectralExpansionBounds(Graph *g, const SpectrumOptions &options = {});
+
+struct LocalClusterOptions {
+  // The number of seed vertices, drawn uniformly at random.  Every vertex is a
+  // seed if this is at least the order of the graph.
+  Graph::OrderTy seed_count = 64;
+
+  // The teleport probability of the personalized PageRank vectors.  Smaller
+  // values spread them further from their seeds and find larger sets.
+  double alpha = 0.05;
+
+  // Vertices holding less residual probability than this times their degree
+  // are not pushed.  A run does O(1 / (alpha * epsilon)) work, however large
+  // the graph.
+  double epsilon = 1e-4;
+
+  unsigned seed = 1;
+};
+
+struct LocalCluster {
+  // The sorted set of at most half the vertices with the least ratio of
+  // boundary vertices to vertices found, and the seed it was found from.
+  // Empty, with an infinite ratio, if the graph has fewer than two vertices.
+  std::vector<Graph::VertexTy> set;
+  Graph::OrderTy boundary_size = 0;
+  double cheeger_upper_bound = std::numeric_limits<double>::infinity();
+  Graph::VertexTy seed_vertex = 0;
+};
+
+// Approximates a personalized PageRank vector around each seed with the push
+// method of Andersen, Chung and Lang, and sweeps the vertices it reaches in
+// order of probability per unit degree.  The seeds are spread over
+// GetDefaultConcurrency() threads.
+LocalCluster FindLocalCluster(Graph *g,
+                              const LocalClusterOptions &options = {});
+} // namespace kb
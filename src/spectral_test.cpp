@@ -0,0 +1,179 @@
+#include "spectral.hpp"
+
+#include "graph_analysis.hpp"
+#include "graph_zoo.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+#include "random_graph.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+using namespace kb;
+
+static bool IsNear(double a, double b) { return std::abs(a - b) < 1e-6; }
+
+static void TestAdjacencySpectrum_Ring() {
+  // The eigenvalues of a ring of n vertices are 2 cos(2 pi k / n).
+  std::unique_ptr<Graph> ring_graph = CreateRingGraph(50);
+  Spectrum spectrum =
+      ComputeSpectrum(ring_graph.get(), {.eigenvalue_count = 3});
+  CHECK(spectrum.converged);
+  CHECK_EQ(spectrum.eigenvalues.size(), 3);
+  CHECK(IsNear(spectrum.eigenvalues[0], 2));
+  CHECK(IsNear(spectrum.eigenvalues[1],
+               2 * std::cos(2 * std::numbers::pi / 50)));
+
+  // The top eigenvector of a regular graph is constant.
+  for (double x : spectrum.eigenvectors[0])
+    CHECK(IsNear(std::abs(x), 1 / std::sqrt(50.0)));
+}
+
+static void TestNormalizedLaplacian_CompleteGraph() {
+  // K_n has normalized Laplacian eigenvalues 0 and n / (n - 1).
+  std::unique_ptr<Graph> complete_graph = CreateCompleteGraph(10, false);
+  Spectrum spectrum = ComputeSpectrum(
+      complete_graph.get(),
+      {.matrix = SpectralMatrix::kNormalizedLaplacian, .eigenvalue_count = 2});
+  CHECK(spectrum.converged);
+  CHECK_EQ(spectrum.eigenvalues[0], 0);
+  CHECK(IsNear(spectrum.eigenvalues[1], 10.0 / 9.0));
+  CHECK_LE(spectrum.residuals[1], 1e-8);
+}
+
+static void TestExpansionBounds_BracketExactConstant() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  for (Graph::OrderTy order : {8, 12, 16}) {
+    std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), order, 3);
+    double exact = ComputeExactCheegerConstant(g.get());
+    SpectralExpansionBounds bounds = ComputeSpectralExpansionBounds(g.get());
+    CHECK(bounds.converged);
+    CHECK_GT(bounds.spectral_gap, 0);
+    CHECK_LE(bounds.cheeger_lower_estimate, exact);
+    CHECK_GE(bounds.cheeger_upper_bound, exact);
+    CHECK_LE(bounds.sweep_set.size(), order / 2);
+  }
+
+  std::unique_ptr<Graph> product = CreateReplacementProduct(
+      CreateCompleteGraph(7, false), CreateRingGraph(6));
+  SpectralExpansionBounds bounds =
+      ComputeSpectralExpansionBounds(product.get());
+  CHECK_GT(bounds.cheeger_lower_estimate, 0);
+  CHECK_LE(bounds.cheeger_lower_estimate, 9.0 / 21.0);
+  CHECK_GE(bounds.cheeger_upper_bound, 9.0 / 21.0);
+
+  // A solver stopped early gives no estimate.
+  SpectralExpansionBounds early_bounds = ComputeSpectralExpansionBounds(
+      product.get(), {.krylov_dimension = 4, .max_restarts = 0});
+  CHECK(!early_bounds.converged);
+  CHECK_EQ(early_bounds.cheeger_lower_estimate, 0);
+  CHECK_GE(early_bounds.cheeger_upper_bound, 9.0 / 21.0);
+}
+
+static void TestExpansionBounds_Disconnected() {
+  std::vector<Graph::EdgeTy> edges = {{0, 1}, {1, 2}, {2, 0},
+                                      {3, 4}, {4, 5}, {5, 3}, {5, 6}};
+  std::unique_ptr<Graph> g = CreateConcreteGraph(7, edges);
+  SpectralExpansionBounds bounds = ComputeSpectralExpansionBounds(g.get());
+  CHECK(IsNear(bounds.spectral_gap, 0));
+  CHECK_EQ(bounds.cheeger_lower_estimate, 0);
+  CHECK_EQ(bounds.cheeger_upper_bound, 0);
+  std::vector<Graph::VertexTy> expected_set = {0, 1, 2};
+  CHECK(bounds.sweep_set == expected_set);
+
+  std::unique_ptr<Graph> unconnected_graph = CreateUnconnectedGraph(4);
+  bounds = ComputeSpectralExpansionBounds(unconnected_graph.get());
+  CHECK_EQ(bounds.spectral_gap, 0);
+  CHECK_EQ(bounds.cheeger_upper_bound, 0);
+  CHECK_EQ(bounds.sweep_set.size(), 1);
+}
+
+// Returns the number of vertices outside `set` with a neighbor in it.
+static Graph::OrderTy CountBoundary(Graph *g,
+                                    const std::vector<Graph::VertexTy> &set) {
+  std::vector<bool> in_set(g->GetOrder()), in_boundary(g->GetOrder());
+  for (Graph::VertexTy v : set)
+    in_set[v] = true;
+  std::vector<Graph::VertexTy> scratch;
+  for (Graph::VertexTy v : set)
+    for (Graph::VertexTy n : g->GetNeighbors(v, &scratch))
+      in_boundary[n] = !in_set[n];
+  return std::count(in_boundary.begin(), in_boundary.end(), true);
+}
+
+static void TestLocalCluster_Barbell() {
+  // Two copies of K_10 joined by a single edge.  Either clique has one
+  // boundary vertex.
+  std::vector<Graph::EdgeTy> edges = {{0, 10}};
+  for (Graph::VertexTy a = 0; a < 10; a++) {
+    for (Graph::VertexTy b = a + 1; b < 10; b++) {
+      edges.push_back({a, b});
+      edges.push_back({a + 10, b + 10});
+    }
+  }
+  std::unique_ptr<Graph> g = CreateConcreteGraph(20, edges);
+  LocalCluster cluster = FindLocalCluster(g.get(), {.seed_count = 4});
+  CHECK_EQ(cluster.set.size(), 10);
+  CHECK_EQ(cluster.boundary_size, 1);
+  CHECK_EQ(cluster.cheeger_upper_bound, 0.1);
+  CHECK_EQ(cluster.set[0] / 10, cluster.seed_vertex / 10);
+}
+
+static void TestLocalCluster_BoundsExactConstant() {
+  auto rbg = CreateDefaultRandomBitGenerator();
+  for (Graph::OrderTy order : {8, 12, 16}) {
+    std::unique_ptr<Graph> g = CreateRandomSparseGraph(rbg.get(), order, 3);
+    LocalCluster cluster = FindLocalCluster(g.get(), {.seed_count = order});
+    CHECK_GE(cluster.cheeger_upper_bound, ComputeExactCheegerConstant(g.get()));
+    CHECK_LE(cluster.set.size(), order / 2);
+    CHECK_EQ(cluster.boundary_size, CountBoundary(g.get(), cluster.set));
+  }
+
+  // Arcs of a long ring have two boundary vertices, but random subsets have
+  // a boundary about as large as themselves.
+  std::unique_ptr<Graph> ring_graph = CreateRingGraph(2000);
+  LocalCluster cluster = FindLocalCluster(ring_graph.get());
+  CHECK_EQ(cluster.boundary_size, 2);
+  CHECK_LE(cluster.cheeger_upper_bound, 0.1);
+  CHECK_LT(cluster.cheeger_upper_bound,
+           DO_NOT_USE_ComputeCheegerConstantUpperBound(ring_graph.get(),
+                                                       rbg.get(), 1000));
+
+  SetDefaultConcurrency(4);
+  LocalCluster parallel = FindLocalCluster(ring_graph.get());
+  SetDefaultConcurrency(0);
+  CHECK(parallel.set == cluster.set);
+  CHECK_EQ(parallel.seed_vertex, cluster.seed_vertex);
+}
+
+static void TestSpectrum_Parallel() {
+  // Dense enough for the matrix-vector product to be split over tasks.  The
+  // normalized Laplacian of K_{l,r} has eigenvalues 0, 1 and 2.
+  std::unique_ptr<Graph> bipartite = CreateCompleteBipartiteGraph(300, 300);
+  SpectrumOptions options = {.matrix = SpectralMatrix::kNormalizedLaplacian,
+                             .eigenvalue_count = 3};
+  Spectrum sequential = ComputeSpectrum(bipartite.get(), options);
+  SetDefaultConcurrency(4);
+  Spectrum parallel = ComputeSpectrum(bipartite.get(), options);
+  SetDefaultConcurrency(0);
+  CHECK(sequential.converged);
+  CHECK(parallel.converged);
+  CHECK(IsNear(sequential.eigenvalues[1], 1));
+  CHECK(IsNear(parallel.eigenvalues[1], 1));
+  CHECK(IsNear(parallel.eigenvalues[2], 2));
+}
+
+#define TEST_LIST(F)                                                           \
+  F(TestAdjacencySpectrum_Ring)                                                \
+  F(TestNormalizedLaplacian_CompleteGraph)                                     \
+  F(TestExpansionBounds_BracketExactConstant)                                  \
+  F(TestExpansionBounds_Disconnected)                                          \
+  F(TestLocalCluster_Barbell)                                                  \
+  F(TestLocalCluster_BoundsExactConstant)                                      \
+  F(TestSpectrum_Parallel)                                                     \
+  (void)0;
+
+DEFINE_MAIN(TEST_LIST)